@@ -39,6 +39,7 @@
 #include "driver/backlight.h"
 #include "functions.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/inputbox.h"
 #include "ui/ui.h"
@@ -145,14 +146,14 @@ void ACTION_Monitor(void)
 	gMonitor = false;
 
 	if (gScanStateDir != SCAN_OFF) {
-		gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+		TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_1_10ms);
 		gScheduleScanListen    = false;
 		gScanPauseMode         = true;
 	}
 
 #ifdef ENABLE_NOAA
 	if (gEeprom.DUAL_WATCH == DUAL_WATCH_OFF && gIsNoaaMode) {
-		gNOAA_Countdown_10ms = NOAA_countdown_10ms;
+		TIMER_Start(TIMER_NOAA, NOAA_countdown_10ms);
 		gScheduleNOAA        = false;
 	}
 #endif
@@ -219,7 +220,7 @@ void ACTION_Scan(bool bRestart)
 
 		// jump to the next channel
 		CHFRSCANNER_Start(false, gScanStateDir);
-		gScanPauseDelayIn_10ms = 1;
+		TIMER_Start(TIMER_SCAN_PAUSE, 1);
 		gScheduleScanListen    = false;
 	} else {
 		// start scanning
@@ -54,17 +54,24 @@
 	#include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
 #include "driver/system.h"
+#include "driver/systick.h"
+#ifdef ENABLE_UART
+	#include "driver/uart.h"
+#endif
 #include "dtmf.h"
 #include "external/printf/printf.h"
 #include "frequencies.h"
 #include "functions.h"
 #include "helper/battery.h"
+#include "helper/pt.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 
 #if defined(ENABLE_OVERLAY)
@@ -86,6 +93,20 @@ static bool flagSaveVfo;
 static bool flagSaveSettings;
 static bool flagSaveChannel;
 
+#ifdef ENABLE_EEPROM_CACHE
+static bool gEepromWriteBack;   // dirty cache lines are going out, one per tick
+#endif
+
+static PT_t        gEndTransmissionThread;
+static PT_t        gEndTransmissionTones;
+static bool        gEndTransmissionInmediately;
+static BEEP_Type_t gEndTransmissionBeep;   // played once back in foreground
+
+#ifdef ENABLE_ALARM
+static PT_t        gAlarmSwitchThread;
+static PT_t        gAlarmSwitchTone;
+#endif
+
 static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 
 
@@ -130,7 +151,7 @@ static void CheckForIncoming(void)
 			#ifdef ENABLE_NOAA
 				if (gIsNoaaMode)
 				{
-					gNOAA_Countdown_10ms = NOAA_countdown_3_10ms;
+					TIMER_Start(TIMER_NOAA, NOAA_countdown_3_10ms);
 					gScheduleNOAA        = false;
 				}
 			#endif
@@ -156,7 +177,7 @@ static void CheckForIncoming(void)
 			return;
 		}
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_rx_10ms;
+		TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_after_rx_10ms);
 		gScheduleDualWatch       = false;
 
 		// let the user see DW is not active
@@ -175,7 +196,7 @@ static void CheckForIncoming(void)
 			return;
 		}
 
-		gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+		TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_3_10ms);
 		gScheduleScanListen    = false;
 	}
 
@@ -233,7 +254,7 @@ static void HandleIncoming(void)
 			if (gRxReceptionMode != RX_MODE_DETECTED) {
 				return;
 			}
-			gDualWatchCountdown_10ms = dual_watch_count_after_1_10ms;
+			TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_after_1_10ms);
 			gScheduleDualWatch       = false;
 
 			gRxReceptionMode = RX_MODE_LISTENING;
@@ -382,7 +403,7 @@ Skip:
 						break;
 
 					case SCAN_RESUME_CO:
-						gScanPauseDelayIn_10ms = scan_pause_delay_in_7_10ms;
+						TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_7_10ms);
 						gScheduleScanListen    = false;
 						break;
 
@@ -398,7 +419,7 @@ Skip:
 			if (gEeprom.TAIL_TONE_ELIMINATION) {
 				AUDIO_AudioPathOff();
 
-				gTailToneEliminationCountdown_10ms = 20;
+				TIMER_Start(TIMER_TAIL_TONE, 20);
 				gFlagTailToneEliminationComplete   = false;
 				gEndOfRxDetectedMaybe = true;
 				gEnableSpeaker        = false;
@@ -465,7 +486,7 @@ void APP_StartListening(FUNCTION_Type_t function)
 		gRxVfo->pTX->Frequency      = NoaaFrequencyTable[gNoaaChannel];
 		gEeprom.ScreenChannel[vfo] = gRxVfo->CHANNEL_SAVE;
 
-		gNOAA_Countdown_10ms        = 500;   // 5 sec
+		TIMER_Start(TIMER_NOAA, 500);   // 5 sec
 		gScheduleNOAA               = false;
 	}
 #endif
@@ -474,7 +495,7 @@ void APP_StartListening(FUNCTION_Type_t function)
 	    gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
 	{	// not scanning, dual watch is enabled
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_2_10ms;
+		TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_after_2_10ms);
 		gScheduleDualWatch       = false;
 
 		// when crossband is active only the main VFO should be used for TX
@@ -570,18 +591,38 @@ static void DualwatchAlternate(void)
 	RADIO_SetupRegisters(false);
 
 	#ifdef ENABLE_NOAA
-		gDualWatchCountdown_10ms = gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms;
+		TIMER_Start(TIMER_DUAL_WATCH, gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms);
 	#else
-		gDualWatchCountdown_10ms = dual_watch_count_toggle_10ms;
+		TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_toggle_10ms);
 	#endif
 }
 
+// a packet is coming in through the BK4819 FIFO, drain it every main loop
+// pass instead of once per 10ms slice so it can't overrun
+static bool RadioPacketInFlight(void)
+{
+#ifdef ENABLE_MESSENGER
+	if (MSG_IsReceiving())
+		return true;
+#endif
+#ifdef ENABLE_AIRCOPY
+	if (gScreenToDisplay == DISPLAY_AIRCOPY && gAircopyState == AIRCOPY_TRANSFER && gAirCopyIsSendMode == 0)
+		return true;
+#endif
+	return false;
+}
+
 static void CheckRadioInterrupts(void)
 {
 	if (SCANNER_IsScanning())
 		return;
 
-	while (BK4819_ReadRegister(BK4819_REG_0C) & 1u) { // BK chip interrupt request
+#ifdef ENABLE_MESSENGER
+	if (MSG_IsSending())   // the send thread polls for its own FSK TX done flag
+		return;
+#endif
+
+	while (BK4819_IsInterruptPending()) { // BK chip interrupt request
 		// clear interrupts
 		BK4819_WriteRegister(BK4819_REG_02, 0);
 		// fetch interrupt status bits
@@ -677,12 +718,12 @@ static void CheckRadioInterrupts(void)
 
 			if (gEeprom.VOX_SWITCH) {
 				if (gCurrentFunction == FUNCTION_POWER_SAVE && !gRxIdleMode) {
-					gPowerSave_10ms            = power_save2_10ms;
+					TIMER_Start(TIMER_POWER_SAVE, power_save2_10ms);
 					gPowerSaveCountdownExpired = 0;
 				}
 
-				if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || gDualWatchCountdown_10ms < dual_watch_count_after_vox_10ms)) {
-					gDualWatchCountdown_10ms = dual_watch_count_after_vox_10ms;
+				if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || TIMER_Remaining(TIMER_DUAL_WATCH) < dual_watch_count_after_vox_10ms)) {
+					TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_after_vox_10ms);
 					gScheduleDualWatch = false;
 
 					// let the user see DW is not active
@@ -728,20 +769,63 @@ static void CheckRadioInterrupts(void)
 	}
 }
 
-void APP_EndTransmission(bool inmediately)
+// the tail of a transmission, resumed every 10ms
+static bool APP_EndTransmissionThread(void)
 {
-	RADIO_SendEndOfTransmission();
+	PT_t *pt = &gEndTransmissionThread;
+
+	PT_BEGIN(pt);
+
+	// the PTT ID of the key-up goes out first
+	PT_WAIT_UNTIL(pt, !FUNCTION_IsKeyingUp());
+
+	if (gCurrentFunction != FUNCTION_TRANSMIT)
+		PT_EXIT(pt);   // the TX was dropped under us, nothing to end
+
+	PT_SPAWN(pt, &gEndTransmissionTones, RADIO_SendEndOfTransmission(&gEndTransmissionTones));
 
 	if (gMonitor) {
 		 //turn the monitor back on
 		gFlagReconfigureVfos = true;
 	}
 
-	if (inmediately || gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0) {
+	if (gEndTransmissionInmediately || gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0) {
 		FUNCTION_Select(FUNCTION_FOREGROUND);
 	} else {
 		gRTTECountdown_10ms = gEeprom.REPEATER_TAIL_TONE_ELIMINATION * 10;
 	}
+
+	if (gEndTransmissionBeep != BEEP_NONE)
+		AUDIO_PlayBeep(gEndTransmissionBeep);
+
+	gUpdateStatus  = true;
+	gUpdateDisplay = true;
+
+	PT_END(pt);
+}
+
+static void APP_StartEndTransmission(bool inmediately, BEEP_Type_t Beep)
+{
+	if (PT_IsRunning(&gEndTransmissionThread))
+		return;   // already on its way down
+
+	gEndTransmissionInmediately = inmediately;
+	gEndTransmissionBeep        = Beep;
+
+	PT_INIT(&gEndTransmissionThread);
+	APP_EndTransmissionThread();
+}
+
+// the roger and PTT ID tones play on from APP_TimeSlice10ms, the TX stays
+// keyed until they are out
+void APP_EndTransmission(bool inmediately)
+{
+	APP_StartEndTransmission(inmediately, BEEP_NONE);
+}
+
+bool APP_IsEndingTransmission(void)
+{
+	return PT_IsRunning(&gEndTransmissionThread);
 }
 
 #ifdef ENABLE_VOX
@@ -774,8 +858,8 @@ static void HandleVox(void)
 
 	if (gVOX_NoiseDetected) {
 		if (g_VOX_Lost)
-			gVoxStopCountdown_10ms = vox_stop_count_down_10ms;
-		else if (gVoxStopCountdown_10ms == 0)
+			TIMER_Start(TIMER_VOX_STOP, vox_stop_count_down_10ms);
+		else if (!TIMER_IsRunning(TIMER_VOX_STOP))
 			gVOX_NoiseDetected = false;
 
 		if (gCurrentFunction == FUNCTION_TRANSMIT && !gPttIsPressed && !gVOX_NoiseDetected) {
@@ -784,14 +868,7 @@ static void HandleVox(void)
 					FUNCTION_Select(FUNCTION_FOREGROUND);
 			}
 			else {
-				APP_EndTransmission(true);
-
-				if (gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0) {
-					//if (gCurrentFunction != FUNCTION_FOREGROUND)
-						FUNCTION_Select(FUNCTION_FOREGROUND);
-				}
-				else
-					gRTTECountdown_10ms = gEeprom.REPEATER_TAIL_TONE_ELIMINATION * 10;
+				APP_EndTransmission(true);   // back to foreground once the tail is out
 			}
 
 			gUpdateStatus        = true;
@@ -820,6 +897,9 @@ static void HandleVox(void)
 
 void APP_Update(void)
 {
+	if (RadioPacketInFlight())
+		CheckRadioInterrupts();
+
 #ifdef ENABLE_VOICE
 	if (gFlagPlayQueuedVoice) {
 			AUDIO_PlayQueuedVoice();
@@ -827,13 +907,11 @@ void APP_Update(void)
 	}
 #endif
 
-	if (gCurrentFunction == FUNCTION_TRANSMIT && (gTxTimeoutReached || SerialConfigInProgress()))
+	if (gCurrentFunction == FUNCTION_TRANSMIT && !APP_IsEndingTransmission() && (gTxTimeoutReached || SerialConfigInProgress()))
 	{	// transmitter timed out or must de-key
 		gTxTimeoutReached = false;
 
-		APP_EndTransmission(true);
-
-		AUDIO_PlayBeep(BEEP_880HZ_60MS_TRIPLE_BEEP);
+		APP_StartEndTransmission(true, BEEP_880HZ_60MS_TRIPLE_BEEP);
 
 		RADIO_SetVfoState(VFO_STATE_TIMEOUT);
 
@@ -871,7 +949,7 @@ void APP_Update(void)
 			NOAA_IncreaseChannel();
 			RADIO_SetupRegisters(false);
 
-			gNOAA_Countdown_10ms = 7;      // 70ms
+			TIMER_Start(TIMER_NOAA, 7);      // 70ms
 			gScheduleNOAA        = false;
 		}
 #endif
@@ -935,7 +1013,7 @@ void APP_Update(void)
 			|| (gIsNoaaMode && (IS_NOAA_CHANNEL(gEeprom.ScreenChannel[0]) || IS_NOAA_CHANNEL(gEeprom.ScreenChannel[1])))
 #endif
 		) {
-			gBatterySaveCountdown_10ms = battery_save_count_10ms;
+			TIMER_Start(TIMER_BATTERY_SAVE, battery_save_count_10ms);
 		} else {
 			FUNCTION_Select(FUNCTION_POWER_SAVE);
 		}
@@ -969,14 +1047,14 @@ void APP_Update(void)
 
 			FUNCTION_Init();
 
-			gPowerSave_10ms = power_save1_10ms; // come back here in a bit
+			TIMER_Start(TIMER_POWER_SAVE, power_save1_10ms); // come back here in a bit
 			gRxIdleMode     = false;            // RX is awake
 		}
 		else if (gEeprom.DUAL_WATCH == DUAL_WATCH_OFF || gScanStateDir != SCAN_OFF || gCssBackgroundScan || goToSleep)
 		{	// dual watch mode off or scanning or rssi update request
 			// go back to sleep
 
-			gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+			TIMER_Start(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
 			gRxIdleMode     = true;
 			goToSleep = false;
 
@@ -990,7 +1068,7 @@ void APP_Update(void)
 		else {
 			// toggle between the two VFO's
 			DualwatchAlternate();
-			gPowerSave_10ms   = power_save1_10ms;
+			TIMER_Start(TIMER_POWER_SAVE, power_save1_10ms);
 			goToSleep = true;
 		}
 
@@ -1013,6 +1091,16 @@ static void CheckKeys(void)
 	}
 #endif
 
+#ifdef ENABLE_MESSENGER
+	if (MSG_IsSending()) {   // PTT or a DTMF key would cut into the FSK burst
+		return;
+	}
+#endif
+
+	if (FUNCTION_IsKeyingUp() || APP_IsEndingTransmission()) {   // same for the PTT ID and roger tones
+		return;
+	}
+
 // -------------------- PTT ------------------------
 	if (gPttIsPressed)
 	{
@@ -1044,71 +1132,73 @@ static void CheckKeys(void)
 
 // --------------------- OTHER KEYS ----------------------------
 
-	// scan the hardware keys
-	KEY_Code_t Key = KEYBOARD_Poll();
-
-	if (Key != KEY_INVALID) // any key pressed
+	// scan the hardware keys, the keypad driver does the debounce and hold timing
+	if (KEYBOARD_Service(gGlobalSysTickCounter) != KEY_INVALID) // any key pressed
 		boot_counter_10ms = 0;   // cancel boot screen/beeps if any key pressed
 
-	if (gKeyReading0 != Key) // new key pressed
+	KEY_Event_t Event;
+	while (KEYBOARD_GetEvent(&Event))
 	{
-
-		if (gKeyReading0 != KEY_INVALID && Key != KEY_INVALID)
-			ProcessKey(gKeyReading1, false, gKeyBeingHeld);  // key pressed without releasing previous key
-
-		gKeyReading0     = Key;
-		gDebounceCounter = 0;
-		return;
-	}
-
-	gDebounceCounter++;
-
-	if (gDebounceCounter == key_debounce_10ms) // debounced new key pressed
-	{
-		if (Key == KEY_INVALID) //all non PTT keys released
+		if (!Event.bKeyPressed) // key released
 		{
-			if (gKeyReading1 != KEY_INVALID) // some button was pressed before
-			{
-				ProcessKey(gKeyReading1, false, gKeyBeingHeld); // process last button released event
-				gKeyReading1 = KEY_INVALID;
-			}
+			ProcessKey(Event.Key, false, Event.bKeyHeld);
+			gKeyReading1  = KEY_INVALID;
+			gKeyBeingHeld = false;
 		}
-		else // process new key pressed
+		else if (!Event.bKeyHeld) // new key pressed
 		{
-			gKeyReading1 = Key;
-			ProcessKey(Key, true, false);
+			gKeyReading1  = Event.Key;
+			ProcessKey(Event.Key, true, false);
+			gKeyBeingHeld = false;
 		}
-
-		gKeyBeingHeld = false;
-		return;
-	}
-
-	if (gDebounceCounter < key_repeat_delay_10ms || Key == KEY_INVALID) // the button is not held long enough for repeat yet, or not really pressed
-		return;
-
-	if (gDebounceCounter == key_repeat_delay_10ms) //initial key repeat with longer delay
-	{
-		if (Key != KEY_PTT)
+		else // key held event
 		{
 			gKeyBeingHeld = true;
-			ProcessKey(Key, true, true); // key held event
+			ProcessKey(Event.Key, true, true);
 		}
 	}
-	else //subsequent fast key repeats
-	{
-		if (Key == KEY_UP || Key == KEY_DOWN) // fast key repeats for up/down buttons
-		{
-			gKeyBeingHeld = true;
-			if ((gDebounceCounter % key_repeat_10ms) == 0)
-				ProcessKey(Key, true, true); // key held event
-		}
+}
 
-		if (gDebounceCounter < 0xFFFF)
-			return;
+#ifdef ENABLE_ALARM
+// swaps the alarm between transmitting and the local siren, resumed every 10ms
+static bool ALARM_SwitchThread(void)
+{
+	PT_t *pt = &gAlarmSwitchThread;
+
+	PT_BEGIN(pt);
+
+	if (gAlarmState == ALARM_STATE_TXALARM) {
+		// still TXALARM during the tail, stopping the alarm now ends the TX properly
+		if(gEeprom.TAIL_TONE_ELIMINATION)
+			PT_SPAWN(pt, &gAlarmSwitchTone, RADIO_SendCssTail(&gAlarmSwitchTone));
+
+		gAlarmState = ALARM_STATE_SITE_ALARM;
+
+		BK4819_SetupPowerAmplifier(0, 0);
+		BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
+		BK4819_Enable_AfDac_DiscMode_TxDsp();
+		BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
 
-		gDebounceCounter = key_repeat_delay_10ms+1;
+		GUI_DisplayScreen();
 	}
+	else {
+		gAlarmState = ALARM_STATE_TXALARM;
+
+		GUI_DisplayScreen();
+
+		BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
+		RADIO_SetTxParameters();
+		PT_SPAWN(pt, &gAlarmSwitchTone, BK4819_TransmitTone(&gAlarmSwitchTone, true, 500));
+		SYSTEM_DelayMs(2);
+		AUDIO_AudioPathOn();
+
+		gEnableSpeaker    = true;
+		gAlarmToneCounter = 0;
+	}
+
+	PT_END(pt);
 }
+#endif
 
 void APP_TimeSlice10ms(void)
 {
@@ -1126,11 +1216,37 @@ void APP_TimeSlice10ms(void)
 #endif
 
 #ifdef ENABLE_UART
-	if (UART_IsCommandAvailable()) {
+	if (gSerialBaudFallback) {
+		gSerialBaudFallback = false;
+		UART_SetBaudRate(UART_BAUD_DEFAULT);   // the PC never confirmed the new rate
+	}
+
+	// a tick can bring several small frames, don't leave any for the next one
+	while (UART_IsCommandAvailable()) {
 		__disable_irq();
 		UART_HandleCommand();
 		__enable_irq();
 	}
+
+	UART_ServiceBulkTransfer();
+#endif
+
+#ifdef ENABLE_EEPROM_CACHE
+	if (gEepromWriteBack && gCurrentFunction != FUNCTION_TRANSMIT)
+		gEepromWriteBack = EEPROM_FlushLine();
+#endif
+
+	// resume the cooperative threads parked on a delay
+	AUDIO_ServiceBeep();
+	FUNCTION_ServiceKeyUp();
+	if (PT_IsRunning(&gEndTransmissionThread))
+		APP_EndTransmissionThread();
+#ifdef ENABLE_ALARM
+	if (PT_IsRunning(&gAlarmSwitchThread))
+		ALARM_SwitchThread();
+#endif
+#ifdef ENABLE_MESSENGER
+	MSG_ServiceSend();
 #endif
 
 	if (gReducedService)
@@ -1193,32 +1309,8 @@ void APP_TimeSlice10ms(void)
 			if (gEeprom.ALARM_MODE == ALARM_MODE_TONE && gAlarmRunningCounter == 512) {
 				gAlarmRunningCounter = 0;
 
-				if (gAlarmState == ALARM_STATE_TXALARM) {
-					gAlarmState = ALARM_STATE_SITE_ALARM;
-
-					if(gEeprom.TAIL_TONE_ELIMINATION)
-						RADIO_SendCssTail();
-					BK4819_SetupPowerAmplifier(0, 0);
-					BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
-					BK4819_Enable_AfDac_DiscMode_TxDsp();
-					BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
-
-					GUI_DisplayScreen();
-				}
-				else {
-					gAlarmState = ALARM_STATE_TXALARM;
-
-					GUI_DisplayScreen();
-
-					BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
-					RADIO_SetTxParameters();
-					BK4819_TransmitTone(true, 500);
-					SYSTEM_DelayMs(2);
-					AUDIO_AudioPathOn();
-
-					gEnableSpeaker    = true;
-					gAlarmToneCounter = 0;
-				}
+				PT_INIT(&gAlarmSwitchThread);
+				ALARM_SwitchThread();
 			}
 		}
 #endif
@@ -1278,11 +1370,47 @@ void cancelUserInputModes(void)
 	}
 }
 
+#ifdef ENABLE_IDLE_SLEEP
+uint8_t         gIdlePercent;
+static uint32_t gIdleCycles;
+
+void APP_Idle(void)
+{
+	// nothing needs 10ms resolution while the radio sleeps, tick less often
+	// but not past the next timer
+	uint32_t Stretch = 1;
+
+	if (gCurrentFunction == FUNCTION_POWER_SAVE && !SerialConfigInProgress() && !AUDIO_IsBeeping())
+		Stretch = MAX(MIN(TIMER_NextDeadline(), 4u), 1u);
+
+	SYSTICK_SetStretch(Stretch);
+
+	// with IRQs masked a tick can't slip in between the check and the WFI,
+	// a pending one still wakes the core up
+	__disable_irq();
+	if (!gNextTimeslice && !RadioPacketInFlight())
+		gIdleCycles += SYSTICK_Sleep();
+	__enable_irq();
+}
+#endif
+
 // this is called once every 500ms
 void APP_TimeSlice500ms(void)
 {
 	gNextTimeslice_500ms = false;
 	bool exit_menu = false;
+
+#ifdef ENABLE_IDLE_SLEEP
+	// share of the last 500ms spent asleep
+	gIdlePercent = MIN(gIdleCycles / (SYSTICK_CORE_CLOCK_MHZ * 5000U), 100U);
+	gIdleCycles  = 0;
+#endif
+
+#ifdef ENABLE_EEPROM_CACHE
+	// write back whatever settings changed since the last slot, a line per
+	// 10ms tick so no single slice blocks for the whole lot
+	gEepromWriteBack = true;
+#endif
 #ifdef ENABLE_MESSENGER_NOTIFICATION
 	if (gPlayMSGRing) {
 		gPlayMSGRingCount = 5;
@@ -1378,6 +1506,7 @@ void APP_TimeSlice500ms(void)
 
 		if (gBatteryCurrent > 500 || gBatteryCalibration[3] < gBatteryCurrentVoltage)
 		{
+			EEPROM_Flush();
 			#ifdef ENABLE_OVERLAY
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -1394,14 +1523,8 @@ void APP_TimeSlice500ms(void)
 
 	if (gCurrentFunction != FUNCTION_TRANSMIT)
 	{
-
-		if ((gBatteryCheckCounter & 1) == 0)
-		{
-			BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[gBatteryVoltageIndex++], &gBatteryCurrent);
-			if (gBatteryVoltageIndex > 3)
-				gBatteryVoltageIndex = 0;
-			BATTERY_GetReadings(true);
-		}
+		// the ADC runs from the tick, this only reads the latest average
+		BATTERY_GetReadings(true);
 	}
 
 	// regular display updates (once every 2 sec) - if need be
@@ -1531,6 +1654,10 @@ void APP_TimeSlice500ms(void)
 #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
 static void ALARM_Off(void)
 {
+#ifdef ENABLE_ALARM
+	PT_INIT(&gAlarmSwitchThread);   // drop a half done switch, ending the TX resets the radio
+#endif
+
 	AUDIO_AudioPathOff();
 	gEnableSpeaker = false;
 
@@ -1565,7 +1692,7 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 	if (gCurrentFunction == FUNCTION_POWER_SAVE)
 		FUNCTION_Select(FUNCTION_FOREGROUND);
 
-	gBatterySaveCountdown_10ms = battery_save_count_10ms;
+	TIMER_Start(TIMER_BATTERY_SAVE, battery_save_count_10ms);
 
 	if (gEeprom.AUTO_KEYPAD_LOCK)
 		gKeyLockCountdown = 30;     // 15 seconds
@@ -1766,8 +1893,10 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 
 				BK4819_DisableScramble();
 
-				if (Code == 0xFE)
-					BK4819_TransmitTone(gEeprom.DTMF_SIDE_TONE, 1750);
+				if (Code == 0xFE) {
+					PT_t Tone;
+					PT_RUN(&Tone, BK4819_TransmitTone(&Tone, gEeprom.DTMF_SIDE_TONE, 1750));
+				}
 				else
 					BK4819_PlayDTMFEx(gEeprom.DTMF_SIDE_TONE, Code);
 			}
@@ -1776,10 +1905,12 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 		else if ((!bKeyHeld && bKeyPressed) || (gAlarmState == ALARM_STATE_TX1750 && bKeyHeld && !bKeyPressed)) {
 			ALARM_Off();
 
-			if (gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0)
-				FUNCTION_Select(FUNCTION_FOREGROUND);
-			else
-				gRTTECountdown_10ms = gEeprom.REPEATER_TAIL_TONE_ELIMINATION * 10;
+			if (!APP_IsEndingTransmission()) {   // else the tail goes back to foreground itself
+				if (gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0)
+					FUNCTION_Select(FUNCTION_FOREGROUND);
+				else
+					gRTTECountdown_10ms = gEeprom.REPEATER_TAIL_TONE_ELIMINATION * 10;
+			}
 
 			if (Key == KEY_PTT)
 				gPttWasPressed  = true;
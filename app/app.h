@@ -28,6 +28,7 @@ extern bool gPlayMSGRing;
 #endif
 
 void     APP_EndTransmission(bool inmediately);
+bool     APP_IsEndingTransmission(void);
 void     APP_StartListening(FUNCTION_Type_t function);
 uint32_t APP_SetFreqByStepAndLimits(VFO_Info_t *pInfo, int8_t direction, uint32_t lower, uint32_t upper);
 uint32_t APP_SetFrequencyByStep(VFO_Info_t *pInfo, int8_t direction);
@@ -35,4 +36,10 @@ void     APP_Update(void);
 void     APP_TimeSlice10ms(void);
 void     APP_TimeSlice500ms(void);
 
+#ifdef ENABLE_IDLE_SLEEP
+extern uint8_t gIdlePercent;
+
+void     APP_Idle(void);
+#endif
+
 #endif
@@ -3,6 +3,7 @@
 #include "app/chFrScanner.h"
 #include "functions.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 
 int8_t            gScanStateDir;
@@ -61,7 +62,7 @@ void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_directi
 		NextFreqChannel();
 	}
 
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_2_10ms;
+	TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_2_10ms);
 	gScheduleScanListen    = false;
 	gRxReceptionMode       = RX_MODE_NONE;
 	gScanPauseMode         = false;
@@ -96,7 +97,7 @@ void CHFRSCANNER_Found(void)
 		case SCAN_RESUME_TO:
 			if (!gScanPauseMode)
 			{
-				gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+				TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_1_10ms);
 				gScheduleScanListen    = false;
 				gScanPauseMode         = true;
 			}
@@ -104,7 +105,7 @@ void CHFRSCANNER_Found(void)
 
 		case SCAN_RESUME_CO:
 		case SCAN_RESUME_SE:
-			gScanPauseDelayIn_10ms = 0;
+			TIMER_Stop(TIMER_SCAN_PAUSE);
 			gScheduleScanListen    = false;
 			break;
 	}
@@ -169,9 +170,9 @@ static void NextFreqChannel(void)
 	RADIO_SetupRegisters(true);
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-	gScanPauseDelayIn_10ms = 9;   // 90ms
+	TIMER_Start(TIMER_SCAN_PAUSE, 9);   // 90ms
 #else
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_6_10ms;
+	TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_6_10ms);
 #endif
 
 	gUpdateDisplay     = true;
@@ -262,9 +263,9 @@ static void NextMemChannel(void)
 	}
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-	gScanPauseDelayIn_10ms = 9;  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
+	TIMER_Start(TIMER_SCAN_PAUSE, 9);  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
 #else
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+	TIMER_Start(TIMER_SCAN_PAUSE, scan_pause_delay_in_3_10ms);
 #endif
 
 	if (enabled)
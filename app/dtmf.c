@@ -78,10 +78,14 @@ void DTMF_clear_RX(void)
 }
 #endif
 
-void DTMF_SendEndOfTransmission(void)
+bool DTMF_SendEndOfTransmission(PT_t *pt)
 {
+	static PT_t ToneThread;
+
+	PT_BEGIN(pt);
+
 	if (gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_APOLLO)
-		BK4819_PlaySingleTone(2475, 250, 28, gEeprom.DTMF_SIDE_TONE);
+		PT_SPAWN(pt, &ToneThread, BK4819_PlaySingleTone(&ToneThread, 2475, 250, 28, gEeprom.DTMF_SIDE_TONE));
 	else if ((gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_TX_DOWN || gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_BOTH)
 #ifdef ENABLE_DTMF_CALLING
 		&& gDTMF_CallState == DTMF_CALL_STATE_NONE
@@ -90,24 +94,26 @@ void DTMF_SendEndOfTransmission(void)
 		if (gEeprom.DTMF_SIDE_TONE) {
 			AUDIO_AudioPathOn();
 			gEnableSpeaker = true;
-			SYSTEM_DelayMs(60);
+			PT_DELAY_MS(pt, 60);
 		}
 
 		BK4819_EnterDTMF_TX(gEeprom.DTMF_SIDE_TONE);
 
-		BK4819_PlayDTMFString(
+		PT_SPAWN(pt, &ToneThread, BK4819_PlayDTMFString(&ToneThread,
 				gEeprom.DTMF_DOWN_CODE,
 				0,
 				gEeprom.DTMF_FIRST_CODE_PERSIST_TIME,
 				gEeprom.DTMF_HASH_CODE_PERSIST_TIME,
 				gEeprom.DTMF_CODE_PERSIST_TIME,
-				gEeprom.DTMF_CODE_INTERVAL_TIME);
+				gEeprom.DTMF_CODE_INTERVAL_TIME));
 
 		AUDIO_AudioPathOff();
 		gEnableSpeaker = false;
 	}
 
 	BK4819_ExitDTMF_TX(true);
+
+	PT_END(pt);
 }
 
 bool DTMF_ValidateCodes(char *pCode, const unsigned int size)
@@ -418,13 +424,17 @@ void DTMF_HandleRequest(void)
 }
 #endif
 
-void DTMF_Reply(void)
+bool DTMF_Reply(PT_t *pt)
 {
-	uint16_t    Delay;
+	static PT_t        ToneThread;
 #ifdef ENABLE_DTMF_CALLING
-	char        String[23];
+	static char        String[23];   // plays on after we return
 #endif
-	const char *pString = NULL;
+	static const char *pString;
+
+	PT_BEGIN(pt);
+
+	pString = NULL;
 
 	switch (gDTMF_ReplyState)
 	{
@@ -463,7 +473,7 @@ void DTMF_Reply(void)
 			    gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_TX_DOWN)
 			{
 				gDTMF_ReplyState = DTMF_REPLY_NONE;
-				return;
+				PT_EXIT(pt);
 			}
 
 			// send TX-UP DTMF
@@ -474,9 +484,7 @@ void DTMF_Reply(void)
 	gDTMF_ReplyState = DTMF_REPLY_NONE;
 
 	if (pString == NULL)
-		return;
-
-	Delay = (gEeprom.DTMF_PRELOAD_TIME < 200) ? 200 : gEeprom.DTMF_PRELOAD_TIME;
+		PT_EXIT(pt);
 
 	if (gEeprom.DTMF_SIDE_TONE)
 	{	// the user will also hear the transmitted tones
@@ -484,21 +492,23 @@ void DTMF_Reply(void)
 		gEnableSpeaker = true;
 	}
 
-	SYSTEM_DelayMs(Delay);
+	PT_DELAY_MS(pt, (gEeprom.DTMF_PRELOAD_TIME < 200) ? 200 : gEeprom.DTMF_PRELOAD_TIME);
 
 	BK4819_EnterDTMF_TX(gEeprom.DTMF_SIDE_TONE);
 
-	BK4819_PlayDTMFString(
+	PT_SPAWN(pt, &ToneThread, BK4819_PlayDTMFString(&ToneThread,
 		pString,
 		1,
 		gEeprom.DTMF_FIRST_CODE_PERSIST_TIME,
 		gEeprom.DTMF_HASH_CODE_PERSIST_TIME,
 		gEeprom.DTMF_CODE_PERSIST_TIME,
-		gEeprom.DTMF_CODE_INTERVAL_TIME);
+		gEeprom.DTMF_CODE_INTERVAL_TIME));
 
 	AUDIO_AudioPathOff();
 
 	gEnableSpeaker = false;
 
 	BK4819_ExitDTMF_TX(false);
+
+	PT_END(pt);
 }
@@ -20,6 +20,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "helper/pt.h"
+
 #define    MAX_DTMF_CONTACTS   16
 
 enum DTMF_State_t {
@@ -84,8 +86,8 @@ bool DTMF_ValidateCodes(char *pCode, const unsigned int size);
 char DTMF_GetCharacter(const unsigned int code);
 void DTMF_clear_input_box(void);
 void DTMF_Append(const char code);
-void DTMF_Reply(void);
-void DTMF_SendEndOfTransmission(void);
+bool DTMF_Reply(PT_t *pt);
+bool DTMF_SendEndOfTransmission(PT_t *pt);
 
 #ifdef ENABLE_DTMF_CALLING
 
@@ -28,6 +28,7 @@
 #include "driver/gpio.h"
 #include "functions.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/inputbox.h"
 #include "ui/ui.h"
@@ -39,7 +40,6 @@
 uint16_t          gFM_Channels[20];
 bool              gFmRadioMode;
 uint8_t           gFmRadioCountdown_500ms;
-volatile uint16_t gFmPlayCountdown_10ms;
 volatile int8_t   gFM_ScanState;
 bool              gFM_AutoScan;
 uint8_t           gFM_ChannelPosition;
@@ -130,7 +130,7 @@ void FM_Tune(uint16_t Frequency, int8_t Step, bool bFlag)
 
 	gEnableSpeaker = false;
 
-	gFmPlayCountdown_10ms = (gFM_ScanState == FM_SCAN_OFF) ? fm_play_countdown_noscan_10ms : fm_play_countdown_scan_10ms;
+	TIMER_Start(TIMER_FM_PLAY, (gFM_ScanState == FM_SCAN_OFF) ? fm_play_countdown_noscan_10ms : fm_play_countdown_scan_10ms);
 
 	gScheduleFM                 = false;
 	gFM_FoundFrequency          = false;
@@ -166,7 +166,7 @@ void FM_PlayAndUpdate(void)
 	BK1080_SetFrequency(gEeprom.FM_FrequencyPlaying, gEeprom.FM_Band/*, gEeprom.FM_Space*/);
 	SETTINGS_SaveFM();
 
-	gFmPlayCountdown_10ms = 0;
+	TIMER_Stop(TIMER_FM_PLAY);
 	gScheduleFM           = false;
 	gAskToSave            = false;
 
@@ -556,7 +556,7 @@ void FM_Play(void)
 {
 	if (!FM_CheckFrequencyLock(gEeprom.FM_FrequencyPlaying, BK1080_GetFreqLoLimit(gEeprom.FM_Band))) {
 		if (!gFM_AutoScan) {
-			gFmPlayCountdown_10ms = 0;
+			TIMER_Stop(TIMER_FM_PLAY);
 			gFM_FoundFrequency    = true;
 
 			if (!gEeprom.FM_IsMrMode)
@@ -31,7 +31,6 @@ enum {
 extern uint16_t          gFM_Channels[20];
 extern bool              gFmRadioMode;
 extern uint8_t           gFmRadioCountdown_500ms;
-extern volatile uint16_t gFmPlayCountdown_10ms;
 extern volatile int8_t   gFM_ScanState;
 extern bool              gFM_AutoScan;
 extern uint8_t           gFM_ChannelPosition;
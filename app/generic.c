@@ -110,12 +110,7 @@ void GENERIC_Key_PTT(bool bKeyPressed)
 				FUNCTION_Select(FUNCTION_FOREGROUND);
 			}
 			else {
-				APP_EndTransmission(true);
-
-				if (gEeprom.REPEATER_TAIL_TONE_ELIMINATION == 0)
-					FUNCTION_Select(FUNCTION_FOREGROUND);
-				else
-					gRTTECountdown_10ms = gEeprom.REPEATER_TAIL_TONE_ELIMINATION * 10;
+				APP_EndTransmission(true);   // back to foreground once the tail is out
 			}
 
 			gFlagEndTransmission = false;
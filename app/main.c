@@ -42,6 +42,7 @@
 #include "frequencies.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/inputbox.h"
 #include "ui/ui.h"
@@ -108,7 +109,7 @@ static void processFKeyFunction(const KEY_Code_t Key, const bool beep)
 				if (gScanStateDir != SCAN_OFF) {
 					if (gCurrentFunction != FUNCTION_INCOMING ||
 						gRxReceptionMode == RX_MODE_NONE      ||
-						gScanPauseDelayIn_10ms == 0)
+						!TIMER_IsRunning(TIMER_SCAN_PAUSE))
 					{	// scan is running (not paused)
 						return;
 					}
@@ -688,7 +689,7 @@ static void MAIN_Key_UP_DOWN(bool bKeyPressed, bool bKeyHeld, int8_t Direction)
 
 	// jump to the next channel
 	CHFRSCANNER_Start(false, Direction);
-	gScanPauseDelayIn_10ms = 1;
+	TIMER_Start(TIMER_SCAN_PAUSE, 1);
 	gScheduleScanListen = false;
 
 	gPttWasReleased = true;
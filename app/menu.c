@@ -1481,6 +1481,7 @@ static void MENU_Key_MENU(const bool bKeyPressed, const bool bKeyHeld)
 						#endif
 
 						MENU_AcceptSetting();
+						EEPROM_Flush();
 
 						#if defined(ENABLE_OVERLAY)
 							overlay_FLASH_RebootToBootloader();
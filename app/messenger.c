@@ -15,6 +15,7 @@
 #include "driver/system.h"
 #include "app/messenger.h"
 #include "common.h"
+#include "helper/pt.h"
 #include "ui/ui.h"
 
 #if defined(ENABLE_UART)
@@ -59,134 +60,34 @@ uint8_t keyTickCounter = 0;
 
 // -----------------------------------------------------
 
-void MSG_FSKSendData() {
+// the send runs as a protothread so the radio stays serviced during the burst
+static PT_t msgSendThread;
+static bool msgServiceMessage;
+static uint8_t msgTxTimeout;
+
+// BK4819 state saved to be restored once the packet is out
+static uint16_t msgSavedCss;
+static uint16_t msgSavedDev;
+static uint16_t msgSavedFilt;
+static uint16_t msgFSKReg59;
+
+static void MSG_FSKSetup(void) {
 
 	uint16_t fsk_reg59;
 
-	// REG_51
-	//
-	// <15>  TxCTCSS/CDCSS   0 = disable 1 = Enable
-	//
-	// turn off CTCSS/CDCSS during FFSK
-	const uint16_t css_val = BK4819_ReadRegister(BK4819_REG_51);
-	BK4819_WriteRegister(BK4819_REG_51, 0);
+	msgSavedCss  = BK4819_ReadRegister(BK4819_REG_51);
+	msgSavedDev  = BK4819_ReadRegister(BK4819_REG_40);
+	msgSavedFilt = BK4819_ReadRegister(BK4819_REG_2B);
 
-	// set the FM deviation level
-	const uint16_t dev_val = BK4819_ReadRegister(BK4819_REG_40);
 	//UART_printf("\n BANDWIDTH : 0x%.4X", dev_val);
+	uint16_t deviation = 850;
+	switch (gEeprom.VfoInfo[gEeprom.TX_VFO].CHANNEL_BANDWIDTH)
 	{
-		uint16_t deviation = 850;
-		switch (gEeprom.VfoInfo[gEeprom.TX_VFO].CHANNEL_BANDWIDTH)
-		{
-			case BK4819_FILTER_BW_WIDE:     deviation = 1050; break;
-			case BK4819_FILTER_BW_NARROW:   deviation =  850; break;
-			case BK4819_FILTER_BW_NARROWER: deviation =  750; break;
-		}
-		//BK4819_WriteRegister(0x40, (3u << 12) | (deviation & 0xfff));
-		BK4819_WriteRegister(BK4819_REG_40, (dev_val & 0xf000) | (deviation & 0xfff));
+		case BK4819_FILTER_BW_WIDE:     deviation = 1050; break;
+		case BK4819_FILTER_BW_NARROW:   deviation =  850; break;
+		case BK4819_FILTER_BW_NARROWER: deviation =  750; break;
 	}
 
-	// REG_2B   0
-	//
-	// <15> 1 Enable CTCSS/CDCSS DC cancellation after FM Demodulation   1 = enable 0 = disable
-	// <14> 1 Enable AF DC cancellation after FM Demodulation            1 = enable 0 = disable
-	// <10> 0 AF RX HPF 300Hz filter     0 = enable 1 = disable
-	// <9>  0 AF RX LPF 3kHz filter      0 = enable 1 = disable
-	// <8>  0 AF RX de-emphasis filter   0 = enable 1 = disable
-	// <2>  0 AF TX HPF 300Hz filter     0 = enable 1 = disable
-	// <1>  0 AF TX LPF filter           0 = enable 1 = disable
-	// <0>  0 AF TX pre-emphasis filter  0 = enable 1 = disable
-	//
-	// disable the 300Hz HPF and FM pre-emphasis filter
-	//
-	const uint16_t filt_val = BK4819_ReadRegister(BK4819_REG_2B);
-	BK4819_WriteRegister(BK4819_REG_2B, (1u << 2) | (1u << 0));
-
-	// *******************************************
-	// setup the FFSK modem as best we can
-
-	// Uses 1200/1800 Hz FSK tone frequencies 1200 bits/s
-	//
-	BK4819_WriteRegister(BK4819_REG_58, // 0x37C3);   // 001 101 11 11 00 001 1
-		(1u << 13) |		// 1 FSK TX mode selection
-							//   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
-							//   1 = FFSK 1200/1800 TX
-							//   2 = ???
-							//   3 = FFSK 1200/2400 TX
-							//   4 = ???
-							//   5 = NOAA SAME TX
-							//   6 = ???
-							//   7 = ???
-							//
-		(7u << 10) |		// 0 FSK RX mode selection
-							//   0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
-							//   1 = ???
-							//   2 = ???
-							//   3 = ???
-							//   4 = FFSK 1200/2400 RX
-							//   5 = ???
-							//   6 = ???
-							//   7 = FFSK 1200/1800 RX
-							//
-		(0u << 8) |			// 0 FSK RX gain
-							//   0 ~ 3
-							//
-		(0u << 6) |			// 0 ???
-							//   0 ~ 3
-							//
-		(0u << 4) |			// 0 FSK preamble type selection
-							//   0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
-							//   1 = ???
-							//   2 = 0x55
-							//   3 = 0xAA
-							//
-		(1u << 1) |			// 1 FSK RX bandwidth setting
-							//   0 = FSK 1.2K .. no tones, direct FM
-							//   1 = FFSK 1200/1800
-							//   2 = NOAA SAME RX
-							//   3 = ???
-							//   4 = FSK 2.4K and FFSK 1200/2400
-							//   5 = ???
-							//   6 = ???
-							//   7 = ???
-							//
-		(1u << 0));			// 1 FSK enable
-							//   0 = disable
-							//   1 = enable
-
-	// REG_72
-	//
-	// <15:0> 0x2854 TONE-2 / FSK frequency control word
-	//        = freq(Hz) * 10.32444 for XTAL 13M / 26M or
-	//        = freq(Hz) * 10.48576 for XTAL 12.8M / 19.2M / 25.6M / 38.4M
-	//
-	// tone-2 = 1200Hz
-	// 18583,92
-	BK4819_WriteRegister(BK4819_REG_72, TONE2_FREQ);
-
-	// REG_70
-	//
-	// <15>   0 TONE-1
-	//        1 = enable
-	//        0 = disable
-	//
-	// <14:8> 0 TONE-1 tuning
-	//
-	// <7>    0 TONE-2
-	//        1 = enable
-	//        0 = disable
-	//
-	// <6:0>  0 TONE-2 / FSK tuning
-	//        0 ~ 127
-	//
-	// enable tone-2, set gain
-	//
-	BK4819_WriteRegister(BK4819_REG_70,   // 0 0000000 1 1100000
-		( 0u << 15) |    // 0
-		( 0u <<  8) |    // 0
-		( 1u <<  7) |    // 1
-		(96u <<  0));    // 96
-
 	// REG_59
 	//
 	// <15>  0 TX FIFO             1 = clear
@@ -222,45 +123,166 @@ void MSG_FSKSendData() {
 				(1u <<  3) |   // 0/1     sync length
 				(0u <<  0);    // 0 ~ 7   ???
 
-	// Set packet length (not including pre-amble and sync bytes that we can't seem to disable)
-	BK4819_WriteRegister(BK4819_REG_5D, ((MSG_HEADER_LENGTH + MAX_RX_MSG_LENGTH) << 8));
+	// the whole modem setup goes out in one burst
+	const BK4819_RegPair_t fsk_setup_table[] =
+	{
+		// REG_51
+		//
+		// <15>  TxCTCSS/CDCSS   0 = disable 1 = Enable
+		//
+		// turn off CTCSS/CDCSS during FFSK
+		{BK4819_REG_51, 0},
 
-	// REG_5A
-	//
-	// <15:8> 0x55 FSK Sync Byte 0 (Sync Byte 0 first, then 1,2,3)
-	// <7:0>  0x55 FSK Sync Byte 1
-	//
-	BK4819_WriteRegister(BK4819_REG_5A, 0x5555);                   // bytes 1 & 2
+		// set the FM deviation level
+		//{BK4819_REG_40, (3u << 12) | (deviation & 0xfff)},
+		{BK4819_REG_40, (msgSavedDev & 0xf000) | (deviation & 0xfff)},
 
-	// REG_5B
-	//
-	// <15:8> 0x55 FSK Sync Byte 2 (Sync Byte 0 first, then 1,2,3)
-	// <7:0>  0xAA FSK Sync Byte 3
-	//
-	BK4819_WriteRegister(BK4819_REG_5B, 0x55AA);                   // bytes 2 & 3
+		// REG_2B   0
+		//
+		// <15> 1 Enable CTCSS/CDCSS DC cancellation after FM Demodulation   1 = enable 0 = disable
+		// <14> 1 Enable AF DC cancellation after FM Demodulation            1 = enable 0 = disable
+		// <10> 0 AF RX HPF 300Hz filter     0 = enable 1 = disable
+		// <9>  0 AF RX LPF 3kHz filter      0 = enable 1 = disable
+		// <8>  0 AF RX de-emphasis filter   0 = enable 1 = disable
+		// <2>  0 AF TX HPF 300Hz filter     0 = enable 1 = disable
+		// <1>  0 AF TX LPF filter           0 = enable 1 = disable
+		// <0>  0 AF TX pre-emphasis filter  0 = enable 1 = disable
+		//
+		// disable the 300Hz HPF and FM pre-emphasis filter
+		//
+		{BK4819_REG_2B, (1u << 2) | (1u << 0)},
 
-	// CRC setting (plus other stuff we don't know what)
-	//
-	// REG_5C
-	//
-	// <15:7> ???
-	//
-	// <6>    1 CRC option enable    0 = disable  1 = enable
-	//
-	// <5:0>  ???
-	//
-	// disable CRC
-	//
-	// NB, this also affects TX pre-amble in some way
-	//
-	BK4819_WriteRegister(BK4819_REG_5C, 0x5625);   // 010101100 0 100101
-//		BK4819_WriteRegister(0x5C, 0xAA30);   // 101010100 0 110000
-//		BK4819_WriteRegister(0x5C, 0x0030);   // 000000000 0 110000
+		// *******************************************
+		// setup the FFSK modem as best we can
+
+		// Uses 1200/1800 Hz FSK tone frequencies 1200 bits/s
+		//
+		{BK4819_REG_58, // 0x37C3,   // 001 101 11 11 00 001 1
+			(1u << 13) |		// 1 FSK TX mode selection
+								//   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
+								//   1 = FFSK 1200/1800 TX
+								//   2 = ???
+								//   3 = FFSK 1200/2400 TX
+								//   4 = ???
+								//   5 = NOAA SAME TX
+								//   6 = ???
+								//   7 = ???
+								//
+			(7u << 10) |		// 0 FSK RX mode selection
+								//   0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
+								//   1 = ???
+								//   2 = ???
+								//   3 = ???
+								//   4 = FFSK 1200/2400 RX
+								//   5 = ???
+								//   6 = ???
+								//   7 = FFSK 1200/1800 RX
+								//
+			(0u << 8) |			// 0 FSK RX gain
+								//   0 ~ 3
+								//
+			(0u << 6) |			// 0 ???
+								//   0 ~ 3
+								//
+			(0u << 4) |			// 0 FSK preamble type selection
+								//   0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
+								//   1 = ???
+								//   2 = 0x55
+								//   3 = 0xAA
+								//
+			(1u << 1) |			// 1 FSK RX bandwidth setting
+								//   0 = FSK 1.2K .. no tones, direct FM
+								//   1 = FFSK 1200/1800
+								//   2 = NOAA SAME RX
+								//   3 = ???
+								//   4 = FSK 2.4K and FFSK 1200/2400
+								//   5 = ???
+								//   6 = ???
+								//   7 = ???
+								//
+			(1u << 0)},			// 1 FSK enable
+								//   0 = disable
+								//   1 = enable
+
+		// REG_72
+		//
+		// <15:0> 0x2854 TONE-2 / FSK frequency control word
+		//        = freq(Hz) * 10.32444 for XTAL 13M / 26M or
+		//        = freq(Hz) * 10.48576 for XTAL 12.8M / 19.2M / 25.6M / 38.4M
+		//
+		// tone-2 = 1200Hz
+		// 18583,92
+		{BK4819_REG_72, TONE2_FREQ},
+
+		// REG_70
+		//
+		// <15>   0 TONE-1
+		//        1 = enable
+		//        0 = disable
+		//
+		// <14:8> 0 TONE-1 tuning
+		//
+		// <7>    0 TONE-2
+		//        1 = enable
+		//        0 = disable
+		//
+		// <6:0>  0 TONE-2 / FSK tuning
+		//        0 ~ 127
+		//
+		// enable tone-2, set gain
+		//
+		{BK4819_REG_70,   // 0 0000000 1 1100000
+			( 0u << 15) |    // 0
+			( 0u <<  8) |    // 0
+			( 1u <<  7) |    // 1
+			(96u <<  0)},    // 96
+
+
+		// Set packet length (not including pre-amble and sync bytes that we can't seem to disable)
+		{BK4819_REG_5D, ((MSG_HEADER_LENGTH + MAX_RX_MSG_LENGTH) << 8)},
+
+		// REG_5A
+		//
+		// <15:8> 0x55 FSK Sync Byte 0 (Sync Byte 0 first, then 1,2,3)
+		// <7:0>  0x55 FSK Sync Byte 1
+		//
+		{BK4819_REG_5A, 0x5555},                   // bytes 1 & 2
+
+		// REG_5B
+		//
+		// <15:8> 0x55 FSK Sync Byte 2 (Sync Byte 0 first, then 1,2,3)
+		// <7:0>  0xAA FSK Sync Byte 3
+		//
+		{BK4819_REG_5B, 0x55AA},                   // bytes 2 & 3
+
+		// CRC setting (plus other stuff we don't know what)
+		//
+		// REG_5C
+		//
+		// <15:7> ???
+		//
+		// <6>    1 CRC option enable    0 = disable  1 = enable
+		//
+		// <5:0>  ???
+		//
+		// disable CRC
+		//
+		// NB, this also affects TX pre-amble in some way
+		//
+		{BK4819_REG_5C, 0x5625},   // 010101100 0 100101
+	//	{0x5C, 0xAA30},   // 101010100 0 110000
+	//	{0x5C, 0x0030},   // 000000000 0 110000
+	};
+
+	BK4819_WriteRegisters(fsk_setup_table, ARRAY_SIZE(fsk_setup_table));
 
 	BK4819_WriteRegister(BK4819_REG_59, (1u << 15) | (1u << 14) | fsk_reg59);   // clear FIFO's
 	BK4819_WriteRegister(BK4819_REG_59, fsk_reg59);
 
-	SYSTEM_DelayMs(100);
+	msgFSKReg59 = fsk_reg59;
+}
+
+static void MSG_FSKStartTX(void) {
 
 	{	// load the entire packet data into the TX FIFO buffer
 		const uint16_t len_buff = (MSG_HEADER_LENGTH + MAX_RX_MSG_LENGTH);
@@ -270,39 +292,39 @@ void MSG_FSKSendData() {
 	}
 
 	// enable FSK TX
-	BK4819_WriteRegister(BK4819_REG_59, (1u << 11) | fsk_reg59);
+	BK4819_WriteRegister(BK4819_REG_59, (1u << 11) | msgFSKReg59);
+}
 
-	{
-		// allow up to 310ms for the TX to complete
-		// if it takes any longer then somethings gone wrong, we shut the TX down
-		unsigned int timeout = 1000 / 5;
+static bool MSG_FSKIsTXFinished(void) {
 
-		while (timeout-- > 0)
-		{
-			SYSTEM_DelayMs(5);
-			if (BK4819_ReadRegister(BK4819_REG_0C) & (1u << 0))
-			{	// we have interrupt flags
-				BK4819_WriteRegister(BK4819_REG_02, 0);
-				if (BK4819_ReadRegister(BK4819_REG_02) & BK4819_REG_02_FSK_TX_FINISHED)
-					timeout = 0;       // TX is complete
-			}
-		}
+	if (BK4819_ReadRegister(BK4819_REG_0C) & (1u << 0))
+	{	// we have interrupt flags
+		BK4819_WriteRegister(BK4819_REG_02, 0);
+		if (BK4819_ReadRegister(BK4819_REG_02) & BK4819_REG_02_FSK_TX_FINISHED)
+			return true;
 	}
-	//BK4819_WriteRegister(BK4819_REG_02, 0);
 
-	SYSTEM_DelayMs(100);
+	return false;
+}
+
+static void MSG_FSKRestore(void) {
 
-	// disable FSK
-	BK4819_WriteRegister(BK4819_REG_59, fsk_reg59);
+	const BK4819_RegPair_t fsk_restore_table[] =
+	{
+		// disable FSK
+		{BK4819_REG_59, msgFSKReg59},
 
-	// restore FM deviation level
-	BK4819_WriteRegister(BK4819_REG_40, dev_val);
+		// restore FM deviation level
+		{BK4819_REG_40, msgSavedDev},
 
-	// restore TX/RX filtering
-	BK4819_WriteRegister(BK4819_REG_2B, filt_val);
+		// restore TX/RX filtering
+		{BK4819_REG_2B, msgSavedFilt},
 
-	// restore the CTCSS/CDCSS setting
-	BK4819_WriteRegister(BK4819_REG_51, css_val);
+		// restore the CTCSS/CDCSS setting
+		{BK4819_REG_51, msgSavedCss},
+	};
+
+	BK4819_WriteRegisters(fsk_restore_table, ARRAY_SIZE(fsk_restore_table));
 
 }
 
@@ -535,6 +557,71 @@ void moveUP(char (*rxMessages)[MAX_RX_MSG_LENGTH + 2]) {
 	memset(rxMessages[3], 0, sizeof(rxMessages[3]));
 }
 
+static bool MSG_SendThread(void) {
+
+	PT_t *pt = &msgSendThread;
+
+	PT_BEGIN(pt);
+
+	BK4819_DisableDTMF();
+
+	//RADIO_SetTxParameters();
+	FUNCTION_Select(FUNCTION_TRANSMIT);
+	//BK4819_PlayRogerNormal(98);
+	PT_WAIT_UNTIL(pt, !FUNCTION_IsKeyingUp());   // a PTT ID goes out before the burst
+	PT_DELAY_MS(pt, 100);
+
+	//BK4819_ExitTxMute();
+
+	MSG_FSKSetup();
+	PT_DELAY_MS(pt, 100);
+
+	// the TX can be ended under us (timeout, serial config), skip what's left of the burst
+	if (gCurrentFunction == FUNCTION_TRANSMIT) {
+
+		MSG_FSKStartTX();
+
+		// allow up to 1s for the TX to complete
+		// if it takes any longer then somethings gone wrong, we shut the TX down
+		for (msgTxTimeout = 1000 / 10; msgTxTimeout > 0; msgTxTimeout--) {
+			PT_DELAY_MS(pt, 10);
+			if (gCurrentFunction != FUNCTION_TRANSMIT || APP_IsEndingTransmission() || MSG_FSKIsTXFinished())
+				break;
+		}
+
+		PT_DELAY_MS(pt, 100);
+	}
+
+	MSG_FSKRestore();
+
+	if (gCurrentFunction == FUNCTION_TRANSMIT) {
+		APP_EndTransmission(true);
+		RADIO_SetVfoState(VFO_STATE_NORMAL);
+		PT_WAIT_UNTIL(pt, !APP_IsEndingTransmission());   // roger and PTT ID first
+	}
+
+	BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
+
+	MSG_EnableRX(true);
+	if (!msgServiceMessage) {
+		// the text is still in the packet buffer, nothing is received while sending
+		const char *txMessage = (const char *)&msgFSKBuffer[2];
+
+		moveUP(rxMessage);
+		sprintf(rxMessage[3], "> %s", txMessage);
+		memset(lastcMessage, 0, sizeof(lastcMessage));
+		strcpy(lastcMessage, txMessage);
+		cIndex = 0;
+		prevKey = 0;
+		prevLetter = 0;
+		memset(cMessage, 0, sizeof(cMessage));
+	}
+	msgStatus = READY;
+	gUpdateDisplay = true;
+
+	PT_END(pt);
+}
+
 void MSG_Send(const char txMessage[TX_MSG_LENGTH], bool bServiceMessage) {
 
 	if ( msgStatus != READY ) return;
@@ -542,6 +629,7 @@ void MSG_Send(const char txMessage[TX_MSG_LENGTH], bool bServiceMessage) {
 	if ( strlen(txMessage) > 0 && (TX_freq_check(gCurrentVfo->pTX->Frequency) == 0) ) {
 
 		msgStatus = SENDING;
+		msgServiceMessage = bServiceMessage;
 
 		RADIO_SetVfoState(VFO_STATE_NORMAL);
 		BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
@@ -564,43 +652,28 @@ void MSG_Send(const char txMessage[TX_MSG_LENGTH], bool bServiceMessage) {
 		msgFSKBuffer[MAX_RX_MSG_LENGTH + 2] = '0';
 		msgFSKBuffer[(MSG_HEADER_LENGTH + MAX_RX_MSG_LENGTH) - 1] = '#';
 
-		BK4819_DisableDTMF();
-
-		//RADIO_SetTxParameters();
-		FUNCTION_Select(FUNCTION_TRANSMIT);
-		//SYSTEM_DelayMs(500);
-		//BK4819_PlayRogerNormal(98);
-		SYSTEM_DelayMs(100);
-
-		//BK4819_ExitTxMute();
-		
-		MSG_FSKSendData();
-
-		SYSTEM_DelayMs(100);
-
-		APP_EndTransmission(true);
-		RADIO_SetVfoState(VFO_STATE_NORMAL);
-
-		BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
-
-		MSG_EnableRX(true);
-		if (!bServiceMessage) {
-			moveUP(rxMessage);
-			sprintf(rxMessage[3], "> %s", txMessage);
-			memset(lastcMessage, 0, sizeof(lastcMessage));
-			memcpy(lastcMessage, txMessage, TX_MSG_LENGTH);
-			cIndex = 0;
-			prevKey = 0;
-			prevLetter = 0;
-			memset(cMessage, 0, sizeof(cMessage));
-		}
-		msgStatus = READY;
+		PT_INIT(&msgSendThread);
+		MSG_SendThread();
 
 	} else {
 		AUDIO_PlayBeep(BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL);
 	}
 }
 
+// resumes a message burst in progress, called every 10ms
+void MSG_ServiceSend(void) {
+	if (PT_IsRunning(&msgSendThread))
+		MSG_SendThread();
+}
+
+bool MSG_IsSending(void) {
+	return msgStatus == SENDING;
+}
+
+bool MSG_IsReceiving(void) {
+	return msgStatus == RECEIVING;
+}
+
 uint8_t validate_char( uint8_t rchar ) {
 	if ( (rchar == 0x1b) || (rchar >= 32 && rchar <= 127) ) {
 		return rchar;
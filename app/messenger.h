@@ -35,6 +35,9 @@ void MSG_StorePacket(const uint16_t interrupt_bits);
 void MSG_Init();
 void MSG_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 void MSG_Send(const char txMessage[TX_MSG_LENGTH], bool bServiceMessage);
+void MSG_ServiceSend(void);
+bool MSG_IsSending(void);
+bool MSG_IsReceiving(void);
 
 #endif
 
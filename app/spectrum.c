@@ -22,6 +22,11 @@
 #endif
 
 #include "driver/backlight.h"
+#include "driver/eeprom.h"
+#ifdef ENABLE_SPECTRUM_STREAM
+#include "app/stream.h"
+#include "driver/uart.h"
+#endif
 #include "frequencies.h"
 #include "ui/helper.h"
 #include "ui/main.h"
@@ -57,10 +62,23 @@ PeakInfo peak;
 ScanInfo scanInfo;
 KeyboardState kbd = {KEY_INVALID, KEY_INVALID, 0};
 
-#ifdef ENABLE_SCAN_RANGES
-static uint16_t blacklistFreqs[15];
-static uint8_t blacklistFreqsIdx;
-#endif
+// Blacklist: the frequencies stay in a sorted list that outlives span and
+// step changes (until cleared with a long SIDE1). Each sweep they are mapped
+// onto a bitset of the steps in view, a step is skipped when a blacklisted
+// frequency falls within half a step of it. Spans of more than 128 steps
+// look the list up by binary search instead.
+// The list is saved at 0x1D00, in the block after the DTMF contacts that
+// factory reset leaves alone: the count, then the entries from 0x1D08.
+#define BLACKLIST_SIZE 32
+#define BLACKLIST_EEPROM 0x1D00
+#define BLACKLIST_EEPROM_LIST (BLACKLIST_EEPROM + 8)
+#define BLACKLIST_FULL_TICKS 200 // "BL FULL" stays up 2s
+
+static uint32_t blacklist[BLACKLIST_SIZE];
+static uint8_t blacklistCount;
+static uint32_t blacklistFullTick;
+static bool blacklistFullShown;
+static uint32_t skipMask[128 / 32];
 
 const char *bwOptions[] = {"  25k", "12.5k", "6.25k"};
 const uint8_t modulationTypeTuneSteps[] = {100, 50, 10};
@@ -76,7 +94,8 @@ SpectrumSettings settings = {.stepsCount = STEPS_64,
                              .listenBw = BK4819_FILTER_BW_WIDE,
                              .modulationType = false,
                              .dbMin = -130,
-                             .dbMax = -50};
+                             .dbMax = -50,
+                             .zoomSweep = false};
 
 uint32_t fMeasure = 0;
 uint32_t currentFreq, tempFreq;
@@ -107,6 +126,116 @@ RegisterSpec registerSpecs[] = {
 
 uint16_t statuslineUpdateTimer = 0;
 
+static uint32_t scanRateSteps;
+static uint32_t scanRateTick;
+static uint16_t scanRate; // steps per second
+
+// Settle detection: after a retune the reading counts once the glitch
+// indicator is valid again and two samples SETTLE_POLL_US apart agree within
+// SETTLE_TOLERANCE. The time that took is learned per band, so the next step
+// sleeps through it. Once a band settled on the first look the steps there
+// only wait for the glitch indicator from the learned time on, every
+// SETTLE_CONFIRM_EVERY'th one still waits for two agreeing samples.
+// settings.scanDelay (us) bounds the wait when a band never settles; such a
+// step teaches nothing.
+#define SETTLE_POLL_US 50
+#define SETTLE_TOLERANCE 2 // RSSI units, 0.5dB each
+#define SETTLE_MAX_RAISE_US 200 // one slow step moves the cache this far at most
+#define SETTLE_CONFIRM_EVERY 8
+
+static uint16_t settleUs[BAND_N_ELEM];
+static uint8_t settleConverged; // one bit per band
+static uint8_t settleConfirm;
+static FREQUENCY_Band_t settleBand;
+
+// Coarse-to-fine (zoom) sweep: a coarse pass measures every zoomFactor'th
+// step with the wide filter and fills the steps in between with its reading.
+// The fine pass then measures only the steps next to a coarse point that
+// stands ZOOM_MARGIN over the coarse average, at the normal scan filter.
+// The wide filter lets in more noise, so the quietest coarse point of each
+// pass is measured again at the scan filter and the difference, smoothed
+// over frames, is taken off everything the coarse pass draws.
+#define ZOOM_MIN_FACTOR 4
+#define ZOOM_MARGIN 12 // RSSI units, 6dB
+#define ZOOM_COARSE_BW scanStepBWRegValues[S_STEP_25_0kHz]
+
+static bool zoomFine;
+static uint16_t zoomFactor;
+static uint8_t zoomCoarse[128]; // coarse readings, RSSI / 2
+static uint32_t zoomSum;
+static uint16_t zoomPoints;     // coarse points measured, skipped ones left out
+static uint8_t zoomThreshold;   // RSSI / 2
+static uint16_t zoomQuietIdx;
+static uint16_t zoomQuietRssi;
+static int16_t zoomFloorOffset; // scan filter floor - coarse filter floor
+
+#ifdef ENABLE_SCAN_RANGES
+// Decimation: a span of more than 128 steps folds into the 128 columns,
+// decimFirst[x] being the first step of column x, built once per span. A
+// cursor follows the sweep through the table, so a step finds its column
+// without a division. Each column keeps the max (rssiHistory) and the min
+// (rssiMinHistory) of its steps, restarted when the sweep enters it and
+// emptied if the sweep passes it without a reading.
+static uint16_t decimFirst[128 + 1];
+static uint16_t decimCount;   // span decimFirst was built for
+static uint8_t decimCol;      // cursor, column of the last step stored
+static uint8_t decimEntered;  // columns the sweep has entered so far
+static uint16_t rssiMinHistory[128];
+#endif
+
+// Trace modes: rssiHistory always holds the last sweep, and at the end of
+// every sweep it is folded into all the accumulators below, so switching the
+// mode shows a trace that has been building up all along. The hold traces
+// keep RSSI / 2, the max hold sinks TRACE_MAX_DECAY per sweep until a reading
+// lifts it again. The average is an exponential one over about
+// 1 << TRACE_AVG_SHIFT sweeps, kept in RSSI << TRACE_AVG_FRAC.
+#define TRACE_MAX_DECAY 1 // RSSI / 2 units, 1dB
+#define TRACE_AVG_SHIFT 3
+#define TRACE_AVG_FRAC 4
+
+static uint8_t traceMax[128];
+static uint8_t traceMin[128];
+static uint16_t traceAvg[128];
+static bool traceSeeded;
+static const char *const traceModeTags[TRACE_N_MODES] = {"", " H", " L", " A"};
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+// Waterfall: the trace shrinks to the rows above WATERFALL_TOP and the last
+// WATERFALL_ROWS sweeps scroll down below it, newest on top. Each sweep is
+// kept as 128 4-bit levels, two per byte, and ordered-dithered to 1bpp when
+// drawn. The pages under the waterfall aren't cleared between frames, a
+// finished sweep shifts them down one row and draws only the new top row.
+#define WATERFALL_ROWS 16
+#define WATERFALL_TOP (DrawingEndY - WATERFALL_ROWS)
+
+static uint8_t waterfall[WATERFALL_ROWS][128 / 2];
+static uint8_t waterfallHead;    // ring slot of the newest sweep
+static uint8_t waterfallSeq;     // sweep counter, keeps the dither with the data
+static uint8_t waterfallPending; // sweeps not drawn yet
+static bool waterfallRedraw = true;
+
+static const uint8_t bayer4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+#endif
+
+#ifdef ENABLE_SPECTRUM_STREAM
+// Sweep streaming: every finished sweep goes out on the UART as one frame, see
+// app/stream.h. A frame is only queued when STREAM_INTERVAL ticks have passed
+// and it fits the TX ring whole, otherwise the sweep is dropped, so the sweep
+// never waits for the UART.
+#define STREAM_INTERVAL 10 // 10ms ticks
+
+static uint32_t streamLastTick;
+static uint8_t streamSeq;
+#endif
+
+// keys with a second function on a long press act on release instead
+static bool kbdHoldDone;
+
 static uint8_t DBm2S(int dbm) {
   uint8_t i = 0;
   dbm *= -1;
@@ -221,6 +350,7 @@ static void ToggleAFDAC(bool on) {
 
 static void SetF(uint32_t f) {
   fMeasure = f;
+  settleBand = FREQUENCY_GetBand(f);
 
   BK4819_SetFrequency(fMeasure);
   BK4819_PickRXFilterPathBasedOnFrequency(fMeasure);
@@ -278,6 +408,12 @@ uint8_t GetBWRegValueForScan() {
 
 //uint16_t GetBWRegValueForScan() { return 0b0000000110111100; }
 
+// the zoom sweep's coarse pass looks through the wide filter
+static uint16_t GetBWRegValueForSweep() {
+  return settings.zoomSweep && !zoomFine ? ZOOM_COARSE_BW
+                                         : GetBWRegValueForScan();
+}
+
 uint16_t GetBWRegValueForListen() {
   return listenBWRegValues[settings.listenBw];
 }
@@ -292,12 +428,61 @@ uint16_t GetBWRegValueForListen() {
 }*/
 
 uint16_t GetRssi() {
-  // SYSTICK_DelayUs(800);
-  // testing autodelay based on Glitch value
-  while ((BK4819_ReadRegister(0x63) & 0b11111111) >= 255) {
-    SYSTICK_DelayUs(50);
+  uint16_t *learned = &settleUs[settleBand];
+  const uint8_t bandBit = 1u << settleBand;
+  uint16_t waited = *learned;
+  uint16_t prev = RSSI_MAX_VALUE;
+  uint16_t rssi;
+  bool settled = false;
+
+  SYSTICK_DelayUs(waited);
+
+  if ((settleConverged & bandBit) && ++settleConfirm % SETTLE_CONFIRM_EVERY) {
+    // the glitch indicator alone, as the stock wait did, from the learned time
+    while ((BK4819_ReadRegister(0x63) & 0b11111111) >= 255 &&
+           waited < settings.scanDelay) {
+      SYSTICK_DelayUs(SETTLE_POLL_US);
+      waited += SETTLE_POLL_US;
+    }
+    if (waited != *learned && waited < settings.scanDelay) {
+      *learned = MIN(waited, *learned + SETTLE_MAX_RAISE_US);
+    }
+    return BK4819_GetRSSI();
+  }
+
+  for (;;) {
+    const bool valid = (BK4819_ReadRegister(0x63) & 0b11111111) < 255;
+    rssi = BK4819_GetRSSI();
+    if (valid && prev != RSSI_MAX_VALUE &&
+        (rssi > prev ? rssi - prev : prev - rssi) <= SETTLE_TOLERANCE) {
+      settled = true;
+      break;
+    }
+    if (waited >= settings.scanDelay) {
+      break;
+    }
+    prev = valid ? rssi : RSSI_MAX_VALUE;
+    SYSTICK_DelayUs(SETTLE_POLL_US);
+    waited += SETTLE_POLL_US;
+  }
+
+  if (!settled) {
+    // timed out, a fading or keying signal rather than the band's settle time
+    return rssi;
+  }
+
+  if (waited == *learned + SETTLE_POLL_US) {
+    // already settled on the first look, try a little less next time
+    *learned -= *learned >> 5;
+    settleConverged |= bandBit;
+  } else {
+    // the first of the two agreeing samples is where it settled
+    const uint16_t settledUs = waited - SETTLE_POLL_US;
+    *learned = settledUs - *learned > SETTLE_MAX_RAISE_US
+                   ? *learned + SETTLE_MAX_RAISE_US
+                   : settledUs;
+    settleConverged &= ~bandBit;
   }
-  uint16_t rssi = BK4819_GetRSSI();
 
   return rssi;
 }
@@ -333,7 +518,7 @@ static void ToggleRX(bool on) {
     listenT = 500;
     BK4819_WriteRegister(0x43, GetBWRegValueForListen());
   } else {
-    BK4819_WriteRegister(0x43, GetBWRegValueForScan());
+    BK4819_WriteRegister(0x43, GetBWRegValueForSweep());
   }
 }
 
@@ -346,6 +531,130 @@ static void ResetScanStats() {
   scanInfo.fPeak = 0;
 }
 
+// first blacklist entry at or above f
+static uint8_t BlacklistLowerBound(uint32_t f) {
+  uint8_t lo = 0, hi = blacklistCount;
+  while (lo < hi) {
+    const uint8_t mid = (lo + hi) >> 1;
+    if (blacklist[mid] < f) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static bool IsBlacklistedF(uint32_t f, uint16_t step) {
+  const uint32_t from = f - step / 2;
+  const uint8_t i = BlacklistLowerBound(from);
+  return i < blacklistCount && blacklist[i] - from < step;
+}
+
+// blank or damaged contents load as an empty list
+static void BlacklistLoad() {
+  EEPROM_ReadBuffer(BLACKLIST_EEPROM, &blacklistCount, 1);
+  if (blacklistCount == 0 || blacklistCount > BLACKLIST_SIZE) {
+    blacklistCount = 0;
+    return;
+  }
+  EEPROM_ReadBuffer(BLACKLIST_EEPROM_LIST, blacklist,
+                    blacklistCount * sizeof(blacklist[0]));
+  for (uint8_t i = 1; i < blacklistCount; ++i) {
+    if (blacklist[i - 1] >= blacklist[i]) {
+      blacklistCount = 0;
+      return;
+    }
+  }
+}
+
+// pages that didn't change are only read back, the count goes in last
+static void BlacklistSave() {
+  EEPROM_WriteRange(BLACKLIST_EEPROM_LIST, blacklist,
+                    blacklistCount * sizeof(blacklist[0]));
+  EEPROM_WriteRange(BLACKLIST_EEPROM, &blacklistCount, 1);
+}
+
+// false when the list is full, f is then not skipped at all
+static bool BlacklistAdd(uint32_t f) {
+  const uint8_t i = BlacklistLowerBound(f);
+  if (i < blacklistCount && blacklist[i] == f) {
+    return true;
+  }
+  if (blacklistCount == BLACKLIST_SIZE) {
+    return false;
+  }
+  memmove(&blacklist[i + 1], &blacklist[i],
+          (blacklistCount - i) * sizeof(blacklist[0]));
+  blacklist[i] = f;
+  blacklistCount++;
+  BlacklistSave();
+  return true;
+}
+
+static void SetStepSkipped(uint16_t idx) {
+  skipMask[idx >> 5] |= 1u << (idx & 31);
+}
+
+// maps the blacklist onto the steps in view and marks their bins
+static void UpdateSkipMask() {
+  memset(skipMask, 0, sizeof(skipMask));
+  if (scanInfo.measurementsCount > 128) {
+    return;
+  }
+
+  const uint32_t fStart = GetFStart() - scanInfo.scanStep / 2;
+  for (uint8_t i = BlacklistLowerBound(fStart); i < blacklistCount; ++i) {
+    const uint32_t idx = (blacklist[i] - fStart) / scanInfo.scanStep;
+    if (idx >= scanInfo.measurementsCount) {
+      break;
+    }
+    SetStepSkipped(idx);
+  }
+
+  for (uint8_t i = 0; i < scanInfo.measurementsCount; ++i) {
+    if (skipMask[i >> 5] & (1u << (i & 31))) {
+      rssiHistory[i] = RSSI_MAX_VALUE;
+    } else if (rssiHistory[i] == RSSI_MAX_VALUE) {
+      rssiHistory[i] = 0;
+    }
+  }
+}
+
+#ifdef ENABLE_SCAN_RANGES
+static void InitDecimation() {
+  decimCol = 0;
+  decimEntered = 0;
+  if (scanInfo.measurementsCount <= 128 ||
+      scanInfo.measurementsCount == decimCount) {
+    return;
+  }
+
+  decimCount = scanInfo.measurementsCount;
+  for (uint8_t x = 0; x <= 128; ++x) {
+    decimFirst[x] = (uint32_t)x * decimCount / 128;
+  }
+}
+
+static uint8_t DecimColumn(uint16_t idx) {
+  if (idx < decimFirst[decimCol]) {
+    decimCol = 0; // back to the peak, or a new pass
+  }
+  while (idx >= decimFirst[decimCol + 1]) {
+    decimCol++;
+  }
+  return decimCol;
+}
+
+// empties the columns the sweep went past, up to column end
+static void DecimSkipTo(uint8_t end) {
+  for (; decimEntered < end; ++decimEntered) {
+    rssiHistory[decimEntered] = 0;
+    rssiMinHistory[decimEntered] = 0;
+  }
+}
+#endif
+
 static void InitScan() {
   ResetScanStats();
   scanInfo.i = 0;
@@ -353,6 +662,20 @@ static void InitScan() {
 
   scanInfo.scanStep = GetScanStep();
   scanInfo.measurementsCount = GetStepsCount();
+
+  // at most 128 coarse points, however long the span
+  zoomFine = false;
+  zoomFactor = MAX(ZOOM_MIN_FACTOR, (scanInfo.measurementsCount + 127) / 128);
+  zoomSum = 0;
+  zoomPoints = 0;
+  zoomQuietRssi = RSSI_MAX_VALUE;
+  UpdateSkipMask();
+#ifdef ENABLE_SCAN_RANGES
+  InitDecimation();
+#endif
+  if (!isListening) {
+    BK4819_WriteRegister(0x43, GetBWRegValueForSweep());
+  }
 }
 
 static void ResetBlacklist() {
@@ -360,10 +683,10 @@ static void ResetBlacklist() {
     if (rssiHistory[i] == RSSI_MAX_VALUE)
       rssiHistory[i] = 0;
   }
-#ifdef ENABLE_SCAN_RANGES
-  memset(blacklistFreqs, 0, sizeof(blacklistFreqs));
-  blacklistFreqsIdx = 0;
-#endif
+  memset(skipMask, 0, sizeof(skipMask));
+  blacklistCount = 0;
+  BlacklistSave();
+  redrawScreen = true;
 }
 
 static void RelaunchScan() {
@@ -375,6 +698,7 @@ static void RelaunchScan() {
 #endif
   preventKeypress = true;
   scanInfo.rssiMin = RSSI_MAX_VALUE;
+  traceSeeded = false;
 }
 
 static void UpdateScanInfo() {
@@ -414,10 +738,19 @@ static void SetRssiHistory(uint16_t idx, uint16_t rssi)
 {
 #ifdef ENABLE_SCAN_RANGES
   if(scanInfo.measurementsCount > 128) {
-    uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * idx / 1000;
-    if(rssiHistory[i] < rssi || isListening)
-      rssiHistory[i] = rssi;
-    rssiHistory[(i+1)%128] = 0;
+    const uint8_t x = DecimColumn(idx);
+
+    // fine steps and the listened peak land in columns laid out already
+    if (!isListening && !(settings.zoomSweep && zoomFine) && decimEntered <= x) {
+      DecimSkipTo(x);
+      rssiHistory[x] = 0;
+      rssiMinHistory[x] = RSSI_MAX_VALUE;
+      decimEntered++;
+    }
+    if(rssiHistory[x] < rssi || isListening)
+      rssiHistory[x] = rssi;
+    if(rssiMinHistory[x] > rssi)
+      rssiMinHistory[x] = rssi;
     return;
   }
 #endif
@@ -430,6 +763,48 @@ static void Measure()
   SetRssiHistory(scanInfo.i, rssi);
 }
 
+// folds the finished sweep into the trace accumulators
+static void UpdateTraces() {
+  for (uint8_t i = 0; i < ARRAY_SIZE(rssiHistory); ++i) {
+    const uint16_t rssi = rssiHistory[i];
+    if (rssi == RSSI_MAX_VALUE) {
+      continue; // blacklisted, keep what was there
+    }
+    const uint8_t half = rssi >> 1;
+    const int16_t fixed = rssi << TRACE_AVG_FRAC;
+
+    if (!traceSeeded) {
+      traceMax[i] = traceMin[i] = half;
+      traceAvg[i] = fixed;
+      continue;
+    }
+
+    const uint8_t max = traceMax[i];
+    traceMax[i] = MAX(max - MIN(max, TRACE_MAX_DECAY), half);
+    traceMin[i] = MIN(traceMin[i], half);
+    traceAvg[i] += (fixed - (int16_t)traceAvg[i]) >> TRACE_AVG_SHIFT;
+  }
+  traceSeeded = true;
+}
+
+// the bin as the selected trace mode shows it
+static uint16_t GetTraceRssi(uint8_t i) {
+  const uint16_t rssi = rssiHistory[i];
+  if (rssi == RSSI_MAX_VALUE || !traceSeeded) {
+    return rssi;
+  }
+  switch (settings.traceMode) {
+  case TRACE_MAX_HOLD:
+    return traceMax[i] << 1;
+  case TRACE_MIN_HOLD:
+    return traceMin[i] << 1;
+  case TRACE_AVERAGE:
+    return traceAvg[i] >> TRACE_AVG_FRAC;
+  default:
+    return rssi;
+  }
+}
+
 // Update things by keypress
 
 static uint16_t dbm2rssi(int dBm) {
@@ -464,7 +839,6 @@ static void ApplyPreset(FreqPreset p) {
   settings.stepsCount = p.stepsCountIndex;
   RADIO_SetModulation(settings.modulationType);
   RelaunchScan();
-  ResetBlacklist();
   redrawScreen = true;
   settings.frequencyChangeStep = GetBW();
 }
@@ -517,7 +891,6 @@ static void UpdateScanStep(bool inc) {
 
   settings.frequencyChangeStep = GetBW() >> 1;
   RelaunchScan();
-  ResetBlacklist();
   redrawScreen = true;
 }
 
@@ -578,6 +951,17 @@ static void ToggleListeningBW() {
   redrawScreen = true;
 }
 
+static void ToggleZoomSweep() {
+  settings.zoomSweep = !settings.zoomSweep;
+  RelaunchScan();
+  redrawScreen = true;
+}
+
+static void NextTraceMode() {
+  settings.traceMode = (settings.traceMode + 1) % TRACE_N_MODES;
+  redrawScreen = true;
+}
+
 static void ToggleBacklight() {
   settings.backlightState = !settings.backlightState;
   if (settings.backlightState) {
@@ -595,7 +979,6 @@ static void ToggleStepsCount() {
   }
   settings.frequencyChangeStep = GetBW() >> 1;
   RelaunchScan();
-  ResetBlacklist();
   redrawScreen = true;
 }
 
@@ -663,26 +1046,22 @@ static void UpdateFreqInput(KEY_Code_t key) {
 }
 
 static void Blacklist() {
-#ifdef ENABLE_SCAN_RANGES
-  blacklistFreqs[blacklistFreqsIdx++ % ARRAY_SIZE(blacklistFreqs)] = peak.i;
-#endif
+  if (!BlacklistAdd(peak.f)) {
+    blacklistFullTick = gGlobalSysTickCounter;
+    blacklistFullShown = true;
+    redrawStatus = true;
+    return;
+  }
+  if (scanInfo.measurementsCount <= 128) {
+    SetStepSkipped(peak.i);
+    SetRssiHistory(peak.i, RSSI_MAX_VALUE);
+  }
 
-  SetRssiHistory(peak.i, RSSI_MAX_VALUE);
   ResetPeak();
   ToggleRX(false);
   ResetScanStats();
 }
 
-#ifdef ENABLE_SCAN_RANGES
-static bool IsBlacklisted(uint16_t idx)
-{
-  for(uint8_t i = 0; i < ARRAY_SIZE(blacklistFreqs); i++)
-    if(blacklistFreqs[i] == idx)
-      return true;
-  return false;
-}
-#endif
-
 // Draw things
 
 // applied x2 to prevent initial rounding
@@ -698,19 +1077,151 @@ uint8_t Rssi2PX(uint16_t rssi, uint8_t pxMin, uint8_t pxMax) {
   return ((dbm - DB_MIN) * PX_RANGE + DB_RANGE / 2) / DB_RANGE + pxMin;
 }
 
+// bottom of the live trace, the waterfall takes the rows below it
+static uint8_t TraceEndY() {
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  if (settings.waterfall) {
+    return WATERFALL_TOP - 1;
+  }
+#endif
+  return DrawingEndY;
+}
+
 uint8_t Rssi2Y(uint16_t rssi) {
-  return DrawingEndY - Rssi2PX(rssi, 0, DrawingEndY);
+  return TraceEndY() - Rssi2PX(rssi, 0, TraceEndY());
+}
+
+// rssiHistory bin shown in display column x
+static uint8_t ColumnBin(uint8_t x) {
+  return scanInfo.measurementsCount > 128 ? x : x >> settings.stepsCount;
 }
 
 static void DrawSpectrum() {
   for (uint8_t x = 0; x < 128; ++x) {
-    uint16_t rssi = rssiHistory[x >> settings.stepsCount];
-    if (rssi != RSSI_MAX_VALUE) {
-      DrawVLine(Rssi2Y(rssi), DrawingEndY, x, true);
+    uint16_t rssi = GetTraceRssi(ColumnBin(x));
+    if (rssi == RSSI_MAX_VALUE) {
+      continue;
     }
+#ifdef ENABLE_SCAN_RANGES
+    if (scanInfo.measurementsCount > 128 && settings.traceMode == TRACE_LIVE) {
+      // min/max envelope of the column, dotted under the min
+      const uint8_t yMin = Rssi2Y(rssiMinHistory[x]);
+      DrawVLine(Rssi2Y(rssi), yMin, x, true);
+      for (uint8_t y = yMin + 2; y <= TraceEndY(); y += 2) {
+        PutPixel(x, y, true);
+      }
+      continue;
+    }
+#endif
+    DrawVLine(Rssi2Y(rssi), TraceEndY(), x, true);
   }
 }
 
+#ifdef ENABLE_SPECTRUM_WATERFALL
+// quantizes the finished sweep into a new ring slot
+static void WaterfallPush() {
+  waterfallHead = (waterfallHead + 1) % WATERFALL_ROWS;
+  waterfallSeq++;
+  if (waterfallPending < WATERFALL_ROWS) {
+    waterfallPending++;
+  }
+
+  uint8_t *row = waterfall[waterfallHead];
+  for (uint8_t x = 0; x < 128; ++x) {
+    const uint16_t rssi = rssiHistory[ColumnBin(x)];
+    const uint8_t level = rssi == RSSI_MAX_VALUE ? 0 : Rssi2PX(rssi, 0, 15);
+    if (x & 1) {
+      row[x >> 1] |= level << 4;
+    } else {
+      row[x >> 1] = level;
+    }
+  }
+}
+
+// draws ring slot back sweeps before the newest at screen row y, which must be blank
+static void DrawWaterfallRow(uint8_t back, uint8_t y) {
+  const uint8_t *row =
+      waterfall[(waterfallHead + WATERFALL_ROWS - back) % WATERFALL_ROWS];
+  const uint8_t *threshold = bayer4x4[(uint8_t)(waterfallSeq - back) & 3];
+  uint8_t *page = gFrameBuffer[y >> 3];
+  const uint8_t bit = 1u << (y & 7);
+
+  for (uint8_t x = 0; x < 128; ++x) {
+    const uint8_t level = (x & 1) ? row[x >> 1] >> 4 : row[x >> 1] & 0x0F;
+    if (level > threshold[x & 3]) {
+      page[x] |= bit;
+    }
+  }
+}
+
+static void DrawWaterfall() {
+  if (waterfallRedraw) {
+    for (uint8_t y = WATERFALL_TOP; y < DrawingEndY; y += 8) {
+      memset(gFrameBuffer[y >> 3], 0, 128);
+    }
+    for (uint8_t i = 0; i < WATERFALL_ROWS; ++i) {
+      DrawWaterfallRow(i, WATERFALL_TOP + i);
+    }
+    waterfallRedraw = false;
+    waterfallPending = 0;
+    return;
+  }
+
+  // scroll one row per new sweep, oldest first
+  for (; waterfallPending > 0; waterfallPending--) {
+    for (uint8_t x = 0; x < 128; ++x) {
+      uint8_t carry = 0;
+      for (uint8_t y = WATERFALL_TOP; y < DrawingEndY; y += 8) {
+        uint8_t *p = &gFrameBuffer[y >> 3][x];
+        const uint8_t out = *p >> 7;
+        *p = (*p << 1) | carry;
+        carry = out;
+      }
+    }
+    DrawWaterfallRow(waterfallPending - 1, WATERFALL_TOP);
+  }
+}
+
+static void ToggleWaterfall() {
+  settings.waterfall = !settings.waterfall;
+  waterfallRedraw = true;
+  redrawScreen = true;
+}
+#endif
+
+#ifdef ENABLE_SPECTRUM_STREAM
+static void StreamSweep() {
+  streamSeq++;
+  if (gGlobalSysTickCounter - streamLastTick < STREAM_INTERVAL) {
+    return;
+  }
+
+  StreamHeader_t header;
+  uint8_t frame[STREAM_FRAME_SIZE(ARRAY_SIZE(rssiHistory))];
+  uint8_t *bins = frame + sizeof(header);
+
+  // spans over 128 steps are already decimated into the 128 bins
+  header.ID = STREAM_ID;
+  header.Count = MIN(scanInfo.measurementsCount, ARRAY_SIZE(rssiHistory));
+  header.Seq = streamSeq;
+  header.Timestamp = gGlobalSysTickCounter;
+  header.FStart = GetFStart();
+  header.Step = (uint32_t)scanInfo.scanStep * scanInfo.measurementsCount / header.Count;
+
+  if (UART_TxFree() < STREAM_FRAME_SIZE(header.Count)) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < header.Count; ++i) {
+    const uint16_t rssi = rssiHistory[i];
+    bins[i] = rssi == RSSI_MAX_VALUE ? STREAM_SKIPPED : StreamEncodeDBm(Rssi2DBm(rssi));
+  }
+
+  UART_Write(frame, StreamBuildFrame(frame, &header));
+  streamLastTick = gGlobalSysTickCounter;
+}
+#endif
+
 static void DrawStatus() {
 #ifdef SPECTRUM_EXTRA_VALUES
   sprintf(String, "%d/%d P:%d T:%d", settings.dbMin, settings.dbMax,
@@ -727,16 +1238,15 @@ static void DrawStatus() {
       p = &freqPresets[i];
     }
   }
-  if (p != NULL) {
+  if (blacklistFullShown) {
+    GUI_DisplaySmallest("BL FULL", 40, 1, true, true);
+  } else if (p != NULL) {
     GUI_DisplaySmallest(p->name, 40, 1, true, true);
   }
 
-  BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[gBatteryCheckCounter++ % 4],
-                           &gBatteryCurrent);
-
-  uint16_t voltage = (gBatteryVoltages[0] + gBatteryVoltages[1] +
-                      gBatteryVoltages[2] + gBatteryVoltages[3]) /
-                     4 * 760 / gBatteryCalibration[3];
+  uint16_t voltage;
+  BOARD_ADC_GetBatteryInfo(&voltage, &gBatteryCurrent);
+  voltage = voltage * 760 / gBatteryCalibration[3];
 
   unsigned perc = BATTERY_VoltsToPercent(voltage);
 
@@ -806,6 +1316,14 @@ static void DrawNums() {
     GUI_DisplaySmallest(String, 0, 1, false, true);
     sprintf(String, "%u.%02uk", GetScanStep() / 100, GetScanStep() % 100);
     GUI_DisplaySmallest(String, 0, 7, false, true);
+
+    // right aligned up to the bandwidth, the channel name has this row while
+    // listening and the sweep is paused then anyway
+    if (!isListening) {
+      sprintf(String, "%u/s%s%s", scanRate, settings.zoomSweep ? " Z" : "",
+              traceModeTags[settings.traceMode]);
+      GUI_DisplaySmallest(String, 106 - 4 * strlen(String), 7, false, true);
+    }
   }
 
   if (IsCenterMode()) {
@@ -899,8 +1417,7 @@ static void OnKeyDown(uint8_t key) {
     //UpdateCurrentFreq(false);
     SelectNearestPreset(false);
     break;
-  case KEY_SIDE1:
-    Blacklist();
+  case KEY_SIDE1: // see OnKeyHold
     break;
   case KEY_STAR:
     UpdateRssiTriggerLevel(true);
@@ -926,14 +1443,13 @@ static void OnKeyDown(uint8_t key) {
 #endif
       ToggleStepsCount();
     break;
-  case KEY_SIDE2:
-    ToggleBacklight();
+  case KEY_SIDE2: // see OnKeyHold
     break;
   case KEY_PTT:
     SetState(STILL);
     TuneToPeak();
     break;
-  case KEY_MENU:
+  case KEY_MENU: // see OnKeyHold
     break;
   case KEY_EXIT:
     if (menuState) {
@@ -976,7 +1492,6 @@ static void OnKeyDownFreqInput(uint8_t key) {
     SetState(previousState);
     currentFreq = tempFreq;
     if (currentState == SPECTRUM) {
-      ResetBlacklist();
       RelaunchScan();
     } else {
       SetF(currentFreq);
@@ -1069,6 +1584,11 @@ static void RenderStatus() {
 static void RenderSpectrum() {
   DrawTicks();
   DrawArrow(128u * peak.i / GetStepsCount());
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  if (settings.waterfall) {
+    DrawWaterfall();
+  }
+#endif
   DrawSpectrum();
   DrawRssiTriggerLevel();
   DrawF(peak.f);
@@ -1140,7 +1660,22 @@ static void RenderStill() {
 }
 
 static void Render() {
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  if (currentState == SPECTRUM && settings.waterfall) {
+    // the waterfall pages are kept, DrawWaterfall only scrolls them
+    ST7565_WaitBlit();
+    for (uint8_t i = 0; i < FRAME_LINES; ++i) {
+      if (i < WATERFALL_TOP / 8 || i >= DrawingEndY / 8) {
+        memset(gFrameBuffer[i], 0, sizeof(gFrameBuffer[i]));
+      }
+    }
+  } else {
+    UI_DisplayClear();
+    waterfallRedraw = true;
+  }
+#else
   UI_DisplayClear();
+#endif
 
   switch (currentState) {
   case SPECTRUM:
@@ -1154,13 +1689,56 @@ static void Render() {
     break;
   }
 
-  ST7565_BlitFullScreen();
+  // the next RSSI sweep runs while the frame goes out
+  ST7565_BlitFullScreenAsync();
+}
+
+// MENU toggles the zoom sweep on release, held it toggles the waterfall.
+// SIDE2 toggles the backlight on release, held it steps the trace mode.
+// SIDE1 blacklists the peak on release, held it clears the blacklist.
+static bool OnKeyHold(KEY_Code_t key) {
+  if (currentState != SPECTRUM ||
+      (key != KEY_MENU && key != KEY_SIDE1 && key != KEY_SIDE2)) {
+    return false;
+  }
+  if (kbd.current == key) {
+    if (kbd.counter == 16 && !kbdHoldDone) {
+      kbdHoldDone = true;
+      if (key == KEY_SIDE1) {
+        ResetBlacklist();
+      } else if (key == KEY_SIDE2) {
+        NextTraceMode();
+      }
+#ifdef ENABLE_SPECTRUM_WATERFALL
+      else {
+        ToggleWaterfall();
+      }
+#endif
+    }
+  } else {
+    if (!kbdHoldDone) {
+      if (key == KEY_SIDE1) {
+        Blacklist();
+      } else if (key == KEY_SIDE2) {
+        ToggleBacklight();
+      } else {
+        ToggleZoomSweep();
+      }
+    }
+    kbdHoldDone = false;
+  }
+  return true;
 }
 
 bool HandleUserInput() {
   kbd.prev = kbd.current;
   kbd.current = GetKey();
 
+  // released after a press that registered
+  if (kbd.prev != KEY_INVALID && kbd.current != kbd.prev && kbd.counter >= 3) {
+    OnKeyHold(kbd.prev);
+  }
+
   if (kbd.current != KEY_INVALID && kbd.current == kbd.prev) {
     if (kbd.counter < 16)
       kbd.counter++;
@@ -1171,6 +1749,10 @@ bool HandleUserInput() {
     kbd.counter = 0;
   }
 
+  if (kbd.current != KEY_INVALID && OnKeyHold(kbd.current)) {
+    return true;
+  }
+
   if (kbd.counter == 3 || kbd.counter == 16) {
     switch (currentState) {
     case SPECTRUM:
@@ -1188,16 +1770,85 @@ bool HandleUserInput() {
   return true;
 }
 
+static bool IsStepSkipped(uint16_t idx) {
+  if (scanInfo.measurementsCount <= 128) {
+    return skipMask[idx >> 5] & (1u << (idx & 31));
+  }
+  return IsBlacklistedF(GetFStart() + (uint32_t)idx * scanInfo.scanStep,
+                        scanInfo.scanStep);
+}
+
+// spreads a level over the coarse point and the steps up to the next one
+static void ZoomFill(uint16_t rssi) {
+  const uint16_t end =
+      MIN(scanInfo.i + zoomFactor, scanInfo.measurementsCount);
+
+  for (uint16_t i = scanInfo.i; i < end; ++i) {
+    if (!IsStepSkipped(i)) {
+      SetRssiHistory(i, rssi);
+    }
+  }
+}
+
+// measures a coarse point, the rest of the sweep sees it at the scan filter's
+// floor, only the hot test works on the raw reading
+static void ZoomMeasureCoarse() {
+  const uint16_t rssi = GetRssi();
+
+  zoomCoarse[scanInfo.i / zoomFactor] = rssi >> 1;
+  zoomSum += rssi;
+  zoomPoints++;
+  if (rssi < zoomQuietRssi) {
+    zoomQuietRssi = rssi;
+    zoomQuietIdx = scanInfo.i;
+  }
+
+  scanInfo.rssi = MAX(0, rssi + zoomFloorOffset);
+  ZoomFill(scanInfo.rssi);
+}
+
+// the quietest coarse point again, now at the scan filter
+static void ZoomLearnFloor() {
+  SetF(GetFStart() + (uint32_t)zoomQuietIdx * scanInfo.scanStep);
+  const int16_t offset = GetRssi() - zoomQuietRssi;
+  zoomFloorOffset += (offset - zoomFloorOffset) / 2;
+}
+
 static void Scan() {
-  if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
-#ifdef ENABLE_SCAN_RANGES
-  && !IsBlacklisted(scanInfo.i)
-#endif
-  ) {
-    SetF(scanInfo.f);
+  const bool coarse = settings.zoomSweep && !zoomFine;
+
+  if (IsStepSkipped(scanInfo.i)) {
+    if (coarse) {
+      // never hot and not in the average, the steps it stands for read 0
+      zoomCoarse[scanInfo.i / zoomFactor] = 0;
+      ZoomFill(0);
+    }
+    return;
+  }
+
+  SetF(scanInfo.f);
+  if (coarse) {
+    ZoomMeasureCoarse();
+  } else {
     Measure();
-    UpdateScanInfo();
   }
+  UpdateScanInfo();
+  scanRateSteps++;
+}
+
+// achieved sweep rate, recomputed about once a second
+static void UpdateScanRate() {
+  const uint32_t elapsed = gGlobalSysTickCounter - scanRateTick;
+  if (elapsed < 100) {
+    return;
+  }
+  const uint16_t rate = scanRateSteps * 100 / elapsed;
+  if (rate != scanRate) {
+    scanRate = rate;
+    redrawScreen = true;
+  }
+  scanRateSteps = 0;
+  scanRateTick = gGlobalSysTickCounter;
 }
 
 static void NextScanStep() {
@@ -1206,10 +1857,59 @@ static void NextScanStep() {
   scanInfo.f += scanInfo.scanStep;
 }
 
+// a step is worth a fine look if a coarse point on either side of it is hot
+static bool ZoomIsHot(uint16_t idx) {
+  const uint16_t k = idx / zoomFactor;
+  const uint16_t points = (scanInfo.measurementsCount + zoomFactor - 1) / zoomFactor;
+
+  return zoomCoarse[k] > zoomThreshold ||
+         (k + 1 < points && zoomCoarse[k + 1] > zoomThreshold);
+}
+
+// moves on to the next step the zoom sweep wants, false once the frame is done
+static bool ZoomNextStep() {
+  ++peak.t;
+
+  if (!zoomFine) {
+    if (scanInfo.i + zoomFactor < scanInfo.measurementsCount) {
+      scanInfo.i += zoomFactor;
+      scanInfo.f += scanInfo.scanStep * zoomFactor;
+      return true;
+    }
+
+    // coarse pass done, the fine pass starts over from the first hot step
+    zoomFine = true;
+    scanInfo.i = 0;
+    BK4819_WriteRegister(0x43, GetBWRegValueForSweep());
+    if (zoomPoints) {
+      zoomThreshold = MIN(255u, (zoomSum / zoomPoints + ZOOM_MARGIN) >> 1);
+      ZoomLearnFloor();
+    } else {
+      zoomThreshold = 255; // all skipped, nothing is hot
+    }
+    if (ZoomIsHot(0)) {
+      scanInfo.f = GetFStart();
+      return true;
+    }
+  }
+
+  do {
+    ++scanInfo.i;
+  } while (scanInfo.i < scanInfo.measurementsCount && !ZoomIsHot(scanInfo.i));
+
+  scanInfo.f = GetFStart() + (uint32_t)scanInfo.i * scanInfo.scanStep;
+
+  return scanInfo.i < scanInfo.measurementsCount;
+}
+
 static void UpdateScan() {
   Scan();
 
-  if (scanInfo.i < scanInfo.measurementsCount) {
+  if (settings.zoomSweep) {
+    if (ZoomNextStep()) {
+      return;
+    }
+  } else if (scanInfo.i < scanInfo.measurementsCount) {
     NextScanStep();
     return;
   }
@@ -1217,10 +1917,22 @@ static void UpdateScan() {
   if(scanInfo.measurementsCount < 128)
     memset(&rssiHistory[scanInfo.measurementsCount], 0,
       sizeof(rssiHistory) - scanInfo.measurementsCount*sizeof(rssiHistory[0]));
+#ifdef ENABLE_SCAN_RANGES
+  else if(scanInfo.measurementsCount > 128)
+    DecimSkipTo(128);
+#endif
 
   redrawScreen = true;
   preventKeypress = false;
 
+  UpdateTraces();
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  WaterfallPush();
+#endif
+#ifdef ENABLE_SPECTRUM_STREAM
+  StreamSweep();
+#endif
+
   UpdatePeakInfo();
   if (IsPeakOverLevel()) {
     ToggleRX(true);
@@ -1311,6 +2023,12 @@ static void Tick() {
       UpdateStill();
     }
   }
+  UpdateScanRate();
+  if (blacklistFullShown &&
+      gGlobalSysTickCounter - blacklistFullTick >= BLACKLIST_FULL_TICKS) {
+    blacklistFullShown = false;
+    redrawStatus = true;
+  }
   if (redrawStatus || ++statuslineUpdateTimer > 4096) {
     RenderStatus();
     redrawStatus = false;
@@ -1336,6 +2054,12 @@ void APP_RunSpectrum() {
   // TX here coz it always? set to active VFO
   vfo =  gEeprom.TX_VFO;
 
+  // the spectrum loop doesn't service the beep thread
+  AUDIO_FinishBeep();
+
+  scanRateSteps = 0;
+  scanRateTick = gGlobalSysTickCounter;
+
   // set the current frequency in the middle of the display
   /*currentFreq = initialFreq = gEeprom.VfoInfo[vfo].pRX->Frequency -
                               ((GetStepsCount() / 2) * GetScanStep());*/
@@ -1353,6 +2077,7 @@ void APP_RunSpectrum() {
   settings.modulationType = vfoi.Modulation;
 
   AutomaticPresetChoose(currentFreq);
+  BlacklistLoad();
 
   isListening = true; // to turn off RX later
   redrawStatus = true;
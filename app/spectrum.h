@@ -103,6 +103,14 @@ typedef enum StepsCount {
   STEPS_16,
 } StepsCount;
 
+typedef enum TraceMode {
+  TRACE_LIVE,
+  TRACE_MAX_HOLD,
+  TRACE_MIN_HOLD,
+  TRACE_AVERAGE,
+  TRACE_N_MODES,
+} TraceMode;
+
 typedef enum ScanStep {
   S_STEP_0_01kHz,
   S_STEP_0_1kHz,
@@ -141,6 +149,11 @@ typedef struct SpectrumSettings {
   int dbMax;  
   ModulationMode_t modulationType;
   bool backlightState;
+  bool zoomSweep;
+  TraceMode traceMode;
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  bool waterfall;
+#endif
 } SpectrumSettings;
 
 typedef struct KeyboardState {
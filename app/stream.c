@@ -0,0 +1,37 @@
+/* Copyright 2023 fagci
+ * https://github.com/fagci
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "app/stream.h"
+#include "driver/crc.h"
+
+uint8_t StreamEncodeDBm(int dbm) {
+  dbm += 160;
+  return dbm <= 0 ? 0 : (dbm >= STREAM_SKIPPED ? STREAM_SKIPPED - 1 : dbm);
+}
+
+uint16_t StreamBuildFrame(uint8_t *pFrame, const StreamHeader_t *header) {
+  const uint16_t size = sizeof(*header) + header->Count;
+  uint16_t crc;
+
+  memcpy(pFrame, header, sizeof(*header));
+  crc = CRC_Update(0, pFrame, size);
+  pFrame[size] = crc & 0xFF;
+  pFrame[size + 1] = crc >> 8;
+
+  return size + 2;
+}
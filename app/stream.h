@@ -0,0 +1,50 @@
+/* Copyright 2023 fagci
+ * https://github.com/fagci
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+
+// Sweep streaming frame: a StreamHeader_t, Count RSSI bytes (dBm + 160,
+// STREAM_SKIPPED for a skipped bin) and the CRC-16/XMODEM of both, all little
+// endian. spectrum-stream.py decodes it, tests/test_stream.py checks the two
+// agree.
+#define STREAM_ID 0xEFAC // next to the 0xEFAB screen dump
+#define STREAM_MAX_BINS 128
+#define STREAM_SKIPPED 0xFF
+
+typedef struct {
+  uint16_t ID;
+  uint8_t Count;      // bins that follow
+  uint8_t Seq;        // sweep counter, a gap means dropped sweeps
+  uint32_t Timestamp; // 10ms ticks at the end of the sweep
+  uint32_t FStart;    // 10Hz units
+  uint32_t Step;      // 10Hz units per bin
+} StreamHeader_t;
+
+// the decoder unpacks '<HBBIII', no padding allowed
+_Static_assert(sizeof(StreamHeader_t) == 16, "StreamHeader_t must be 16 bytes");
+
+#define STREAM_FRAME_SIZE(count) (sizeof(StreamHeader_t) + (count) + 2)
+
+uint8_t StreamEncodeDBm(int dbm);
+
+// pFrame holds the Count bins at pFrame + sizeof(StreamHeader_t) already,
+// fills in the header and the CRC around them, returns the frame size
+uint16_t StreamBuildFrame(uint8_t *pFrame, const StreamHeader_t *header);
+
+#endif
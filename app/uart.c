@@ -26,6 +26,9 @@
 	#include "app/messenger.h"
   	#include "external/printf/printf.h"
 #endif
+#ifdef ENABLE_IDLE_SLEEP
+	#include "app/app.h"
+#endif
 #include "app/uart.h"
 #include "board.h"
 #include "bsp/dp32g030/dma.h"
@@ -36,6 +39,7 @@
 #include "driver/crc.h"
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
+#include "driver/systick.h"
 #include "driver/uart.h"
 #include "functions.h"
 #include "misc.h"
@@ -148,6 +152,79 @@ typedef struct {
 	uint32_t Timestamp;
 } CMD_052F_t;
 
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint16_t Length;
+	uint8_t  Window;    // frames in flight before an ack is needed
+	uint8_t  Padding[3];
+	uint32_t Timestamp;
+} CMD_0540_t; // bulk eeprom read
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint16_t Seq;
+		uint16_t Offset;
+		uint8_t  Size;
+		bool     bRejected; // the range asked for is not in the EEPROM, nothing follows
+		uint8_t  Data[128];
+	} Data;
+} REPLY_0541_t;
+
+typedef struct {
+	Header_t Header;
+	uint16_t Base;      // every frame below this has arrived
+	uint16_t Missing;   // bit n set = frame Base + n has to be sent again
+	uint32_t Timestamp;
+} CMD_0542_t; // bulk eeprom read ack
+
+typedef struct {
+	Header_t Header;
+	uint16_t Seq;
+	uint16_t Offset;
+	uint8_t  Size;
+	bool     bAllowPassword;
+	uint8_t  Padding[2];
+	uint32_t Timestamp;
+	uint8_t  Data[0];
+} CMD_0543_t; // bulk eeprom write frame
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint16_t Seq;
+		uint16_t Offset;
+		uint8_t  Window;    // write frames the PC may send before waiting for an ack
+		bool     bRejected; // nothing was written, the frame is malformed, out of range or the radio locked
+		uint8_t  Padding[2];
+	} Data;
+} REPLY_0544_t;
+
+typedef struct {
+	Header_t Header;
+	uint32_t BaudRate;
+	uint32_t Timestamp;
+} CMD_05E1_t; // switch baud rate
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint32_t BaudRate;  // 0 = rejected
+	} Data;
+} REPLY_05E1_t;
+
+#ifdef ENABLE_IDLE_SLEEP
+typedef struct {
+	Header_t Header;
+	struct {
+		uint8_t IdlePercent;    // share of the last 500ms the CPU slept
+		uint8_t TickStretch;    // 10ms ticks per SysTick interrupt
+		uint8_t Padding[2];
+	} Data;
+} REPLY_05E6_t;
+#endif
+
 
 #ifdef ENABLE_SCREEN_DUMP
 typedef struct {
@@ -297,6 +374,41 @@ static void CMD_051B(const uint8_t *pBuffer)
 	SendReply(&Reply, pCmd->Size + 8);
 }
 
+// writes 8 byte blocks, returns true when the AES key/lock area changed.
+// The blocks go out in runs so that a 128 byte frame costs 4 page writes
+// rather than 16
+static bool WriteEeprom(uint16_t Offset, const uint8_t *pData, uint8_t Size, bool bAllowPassword)
+{
+	bool bReloadEeprom = false;
+	unsigned int Run = 0;   // bytes in the run of blocks not written yet
+	unsigned int i;
+
+	for (i = 0; i + 8U <= Size; i += 8U)
+	{
+		const uint16_t Address = Offset + i;
+
+		if (Address >= 0x0F30 && Address < 0x0F40)
+			if (!gIsLocked)
+				bReloadEeprom = true;
+
+		if ((Address < 0x0E98 || Address >= 0x0EA0) || !bIsInLockScreen || bAllowPassword)
+		{
+			Run += 8U;
+			continue;
+		}
+
+		// the password block is left alone, write out what came before it
+		if (Run > 0)
+			EEPROM_WriteRange(Address - Run, &pData[i - Run], Run);
+		Run = 0;
+	}
+
+	if (Run > 0)
+		EEPROM_WriteRange(Offset + i - Run, &pData[i - Run], Run);
+
+	return bReloadEeprom;
+}
+
 // write eeprom
 static void CMD_051D(const uint8_t *pBuffer)
 {
@@ -324,23 +436,169 @@ static void CMD_051D(const uint8_t *pBuffer)
 
 	if (!bIsLocked)
 	{
-		unsigned int i;
-		for (i = 0; i < (pCmd->Size / 8); i++)
-		{
-			const uint16_t Offset = pCmd->Offset + (i * 8U);
+		bReloadEeprom = WriteEeprom(pCmd->Offset, pCmd->Data, pCmd->Size, pCmd->bAllowPassword);
+		if (bReloadEeprom)
+			SETTINGS_InitEEPROM();
+	}
 
-			if (Offset >= 0x0F30 && Offset < 0x0F40)
-				if (!gIsLocked)
-					bReloadEeprom = true;
+	SendReply(&Reply, sizeof(Reply));
+}
 
-			if ((Offset < 0x0E98 || Offset >= 0x0EA0) || !bIsInLockScreen || pCmd->bAllowPassword)
-				EEPROM_WriteBuffer(Offset, &pCmd->Data[i * 8U]);
-		}
+// bulk transfers: the radio streams a read range as numbered frames, up to
+// Window of them unacknowledged, and sends again whatever the PC reports
+// missing. One frame is queued per 10ms tick, at UART_BAUD_MAX a frame
+// takes 12.7ms on the wire so that keeps the line busy.
+// Writes are numbered frames, each one acked on its own once it is in
+// the EEPROM so the PC can resend just the ones that got lost. The ack
+// says how many frames the PC may have in flight: a frame is 152 bytes
+// and the commands are handled with interrupts off while the page writes
+// run, so a second frame behind it would lap the 256 byte RX ring.
+
+#define BULK_FRAME_SIZE    128U
+#define BULK_WINDOW_MAX    16U
+#define BULK_WRITE_WINDOW  1U
+
+static struct {
+	uint16_t Offset;
+	uint16_t Length;
+	uint16_t Frames;
+	uint16_t Base;      // oldest frame not acked yet
+	uint16_t Next;      // next frame never sent
+	uint16_t Resend;    // bit n = send frame Base + n again
+	uint8_t  Window;
+	uint8_t  Idle_10ms;
+	bool     bActive;
+} gBulkRead;
+
+static void CMD_0540(const uint8_t *pBuffer)
+{
+	const CMD_0540_t *pCmd = (const CMD_0540_t *)pBuffer;
 
-		if (bReloadEeprom)
-			SETTINGS_InitEEPROM();
+	if (pCmd->Timestamp != Timestamp)
+		return;
+
+	gSerialConfigCountDown_500ms = 12; // 6 sec
+
+	memset(&gBulkRead, 0, sizeof(gBulkRead));
+
+	if (pCmd->Length == 0 || pCmd->Offset >= 0x2000 || pCmd->Length > 0x2000 - pCmd->Offset)
+	{
+		REPLY_0541_t Reply;
+
+		memset(&Reply, 0, sizeof(Reply));
+		Reply.Header.ID      = 0x0541;
+		Reply.Header.Size    = sizeof(Reply.Data);
+		Reply.Data.Offset    = pCmd->Offset;
+		Reply.Data.bRejected = true;
+		SendReply(&Reply, sizeof(Reply));
+		return;
 	}
 
+	gBulkRead.Offset  = pCmd->Offset;
+	gBulkRead.Length  = pCmd->Length;
+	gBulkRead.Frames  = (pCmd->Length + BULK_FRAME_SIZE - 1) / BULK_FRAME_SIZE;
+	gBulkRead.Window  = (pCmd->Window == 0 || pCmd->Window > BULK_WINDOW_MAX) ? BULK_WINDOW_MAX : pCmd->Window;
+	gBulkRead.bActive = true;
+}
+
+static void CMD_0542(const uint8_t *pBuffer)
+{
+	const CMD_0542_t *pCmd = (const CMD_0542_t *)pBuffer;
+
+	if (pCmd->Timestamp != Timestamp || !gBulkRead.bActive)
+		return;
+
+	gSerialConfigCountDown_500ms = 12; // 6 sec
+	gBulkRead.Idle_10ms = 0;
+
+	if (pCmd->Base > gBulkRead.Base && pCmd->Base <= gBulkRead.Next) {
+		gBulkRead.Resend >>= pCmd->Base - gBulkRead.Base;
+		gBulkRead.Base     = pCmd->Base;
+	}
+
+	if (pCmd->Base == gBulkRead.Base)
+		gBulkRead.Resend |= pCmd->Missing & ((1u << (gBulkRead.Next - gBulkRead.Base)) - 1u);
+
+	if (gBulkRead.Base >= gBulkRead.Frames)
+		gBulkRead.bActive = false;
+}
+
+static void SendBulkFrame(uint16_t Seq)
+{
+	REPLY_0541_t   Reply;
+	const uint16_t Offset = Seq * BULK_FRAME_SIZE;
+	uint8_t        Size   = BULK_FRAME_SIZE;
+
+	if (Size > gBulkRead.Length - Offset)
+		Size = gBulkRead.Length - Offset;
+
+	memset(&Reply, 0, sizeof(Reply));
+	Reply.Header.ID   = 0x0541;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.Seq    = Seq;
+	Reply.Data.Offset = gBulkRead.Offset + Offset;
+	Reply.Data.Size   = Size;
+
+	if (!(bHasCustomAesKey && gIsLocked))
+		EEPROM_ReadBuffer(Reply.Data.Offset, Reply.Data.Data, Size);
+
+	SendReply(&Reply, sizeof(Reply));
+}
+
+void UART_ServiceBulkTransfer(void)
+{
+	if (!gBulkRead.bActive)
+		return;
+
+	if (!SerialConfigInProgress()) {
+		gBulkRead.bActive = false;   // the PC went away
+		return;
+	}
+
+	// only queue a frame when it fits, this never waits on the UART
+	if (UART_TxFree() < sizeof(REPLY_0541_t) + sizeof(Header_t) + sizeof(Footer_t))
+		return;
+
+	if (gBulkRead.Resend != 0) {
+		unsigned int n = 0;
+		while ((gBulkRead.Resend & (1u << n)) == 0)
+			n++;
+		gBulkRead.Resend &= ~(1u << n);
+		SendBulkFrame(gBulkRead.Base + n);
+	}
+	else if (gBulkRead.Next < gBulkRead.Frames && gBulkRead.Next < gBulkRead.Base + gBulkRead.Window) {
+		SendBulkFrame(gBulkRead.Next++);
+	}
+	else if (++gBulkRead.Idle_10ms >= 100) {
+		// no ack for a second, send everything outstanding again
+		gBulkRead.Idle_10ms = 0;
+		gBulkRead.Resend    = (1u << (gBulkRead.Next - gBulkRead.Base)) - 1u;
+	}
+}
+
+static void CMD_0543(const uint8_t *pBuffer)
+{
+	const CMD_0543_t *pCmd = (const CMD_0543_t *)pBuffer;
+	REPLY_0544_t      Reply;
+
+	if (pCmd->Timestamp != Timestamp)
+		return;
+
+	gSerialConfigCountDown_500ms = 12; // 6 sec
+
+	memset(&Reply, 0, sizeof(Reply));
+	Reply.Header.ID   = 0x0544;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.Seq    = pCmd->Seq;
+	Reply.Data.Offset = pCmd->Offset;
+	Reply.Data.Window = BULK_WRITE_WINDOW;
+
+	// EEPROM_WriteRange() drops a range past the end whole, say so rather than ack it
+	if (pCmd->Size > BULK_FRAME_SIZE || (pCmd->Size % 8) != 0 || pCmd->Offset + pCmd->Size > 0x2000 || (bHasCustomAesKey && gIsLocked))
+		Reply.Data.bRejected = true;
+	else if (WriteEeprom(pCmd->Offset, pCmd->Data, pCmd->Size, pCmd->bAllowPassword))
+		SETTINGS_InitEEPROM();
+
 	SendReply(&Reply, sizeof(Reply));
 }
 
@@ -452,6 +710,76 @@ static void CMD_052F(const uint8_t *pBuffer)
 	SendVersion();
 }
 
+// the reply goes out at the old rate, then the PC has 1 sec to get a
+// 0x05E3 through at the new one or the radio drops back to 38400, as it
+// also does when the session times out. Faster rates than UART_BAUD_MAX
+// would overrun the RX ring, see driver/uart.h
+static void CMD_05E1(const uint8_t *pBuffer)
+{
+	const CMD_05E1_t *pCmd = (const CMD_05E1_t *)pBuffer;
+	REPLY_05E1_t      Reply;
+
+	if (pCmd->Timestamp != Timestamp)
+		return;
+
+	gSerialConfigCountDown_500ms = 12; // 6 sec
+
+	Reply.Header.ID   = 0x05E2;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.BaudRate = 0;
+
+	switch (pCmd->BaudRate)
+	{
+		case UART_BAUD_DEFAULT:
+		case 57600:
+		case UART_BAUD_MAX:
+			Reply.Data.BaudRate = pCmd->BaudRate;
+			break;
+	}
+
+	SendReply(&Reply, sizeof(Reply));
+
+	if (Reply.Data.BaudRate == 0)
+		return;
+
+	UART_WaitTxDone();
+	UART_SetBaudRate(pCmd->BaudRate);
+
+	if (pCmd->BaudRate != UART_BAUD_DEFAULT)
+		gSerialBaudCountdown_10ms = 100;   // 1 sec
+}
+
+// handshake at the new baud rate, keeps it
+static void CMD_05E3(void)
+{
+	REPLY_05E1_t Reply;
+
+	Reply.Header.ID   = 0x05E4;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.BaudRate = 1;
+
+	gSerialBaudCountdown_10ms = 0;
+	gSerialConfigCountDown_500ms = 12; // 6 sec
+
+	SendReply(&Reply, sizeof(Reply));
+}
+
+#ifdef ENABLE_IDLE_SLEEP
+// idle statistics
+static void CMD_05E5(void)
+{
+	REPLY_05E6_t Reply;
+
+	memset(&Reply, 0, sizeof(Reply));
+	Reply.Header.ID        = 0x05E6;
+	Reply.Header.Size      = sizeof(Reply.Data);
+	Reply.Data.IdlePercent = gIdlePercent;
+	Reply.Data.TickStretch = gSysTickStretch;
+
+	SendReply(&Reply, sizeof(Reply));
+}
+#endif
+
 #ifdef ENABLE_SCREEN_DUMP
 static void CMD_0A03() // dumps the LCD screen memory to the PC. Not used in the Dock, is just for debug purposes
 {
@@ -515,148 +843,165 @@ static void CMD_0602_WriteBK4819Reg(const uint8_t *pBuffer)
 }
 #endif
 
+// frame parser, fed one byte at a time as the RX DMA ring fills so that
+// nothing is looked at twice
+typedef enum {
+	UART_RX_IDLE,           // hunting for 0xAB (or the 'S' of a text line)
+	UART_RX_START,          // 0xAB seen, 0xCD must follow
+	UART_RX_SIZE_LO,
+	UART_RX_SIZE_HI,
+	UART_RX_PAYLOAD,        // Size bytes of command + 2 bytes of CRC
+	UART_RX_END_1,          // 0xDC
+	UART_RX_END_2,          // 0xBA
 #if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
-void remove(char cstring[], char letter) {
-    for(int i = 0; cstring[i] != '\0'; i++) {
-        if(cstring[i] == letter) cstring[i] = '\0';
-    } 
-}
-bool findchar(uint8_t start, char letter) {
-    for(int i = start; UART_DMA_Buffer[i] != '\0'; i++) {
-        if(UART_DMA_Buffer[i] == letter) return true;
-    } 
-	return false;
-}
-
-uint8_t txtStart = 0;
-bool newTxtMsg = false;
-
+	UART_RX_TEXT_PREFIX,    // "SMS:"
+	UART_RX_TEXT,           // message text up to '\n'
 #endif
+} UART_RxState_t;
 
-bool UART_IsCommandAvailable(void)
-{
-	uint16_t Index;
-	uint16_t TailIndex;
-	uint16_t Size;
-	uint16_t CRC;
-	uint16_t CommandLength;
-	uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
-
-	while (1)
-	{
-		if (gUART_WriteIndex == DmaLength)
-			return false;
+static UART_RxState_t gUART_RxState;
+static uint16_t       gUART_RxSize;
+static uint16_t       gUART_RxCount;
+static uint16_t       gUART_RxCrc;     // running CRC of the payload received so far
+static bool           gUART_RxEncrypted;   // obfuscation of this frame, kept once its CRC matches
 
 #if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+static char gUART_TextLine[TX_MSG_LENGTH + 4];
 
-		if ( UART_DMA_Buffer[gUART_WriteIndex] == 'S' && UART_DMA_Buffer[gUART_WriteIndex + 1] == 'M' && UART_DMA_Buffer[ gUART_WriteIndex + 2] == 'S' && UART_DMA_Buffer[gUART_WriteIndex + 3] == ':') {
-			txtStart = gUART_WriteIndex;
-			newTxtMsg = true;
-			//UART_printf("1:%s\r\n", &UART_DMA_Buffer[txtStart]);
-		}
+static void UART_HandleTextLine(void)
+{
+	gUART_TextLine[gUART_RxCount] = '\0';
 
-		if (findchar(txtStart, '\n') && newTxtMsg) {
-			//UART_printf("2:%s\r\n", &UART_DMA_Buffer[txtStart]);
-			char txMessage[TX_MSG_LENGTH + 4];
-			memset(txMessage, 0, sizeof(txMessage));
-			snprintf(txMessage, (TX_MSG_LENGTH + 4), "%s", &UART_DMA_Buffer[txtStart + 4]);
+	if (gUART_RxCount > 0) {
+		MSG_Send(gUART_TextLine, false);
+		UART_printf("SMS>%s\r\n", gUART_TextLine);
+		gUpdateDisplay = true;
+	}
+}
+#endif
 
-			remove(txMessage, '\n');
-			remove(txMessage, '\r');      
+// returns true once a complete frame with a good CRC is in UART_Command
+static bool UART_ParseByte(uint8_t Byte)
+{
+	switch (gUART_RxState)
+	{
+		case UART_RX_IDLE:
+			break;
 
-			if (strlen(txMessage) > 0) {        
-				MSG_Send(txMessage, false);
-				UART_printf("SMS>%s\r\n", txMessage);
-				gUpdateDisplay = true;
+		case UART_RX_START:
+			if (Byte == 0xCD) {
+				gUART_RxState = UART_RX_SIZE_LO;
+				return false;
 			}
-			newTxtMsg = false;
-			txtStart = 0;
-			memset(UART_DMA_Buffer, 0, sizeof(UART_DMA_Buffer));
-			gUART_WriteIndex = 0;
-			return false;			
-		}
-		
-		while (gUART_WriteIndex != DmaLength && UART_DMA_Buffer[gUART_WriteIndex] != 0xABU && UART_DMA_Buffer[gUART_WriteIndex] != 'S')
-			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
-#else  
-		while (gUART_WriteIndex != DmaLength && UART_DMA_Buffer[gUART_WriteIndex] != 0xABU)
-			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
-#endif  
-
-		if (gUART_WriteIndex == DmaLength)
-			return false;
+			break;      // may be the start of the next frame
 
-		if (gUART_WriteIndex < DmaLength)
-			CommandLength = DmaLength - gUART_WriteIndex;
-		else
-			CommandLength = (DmaLength + sizeof(UART_DMA_Buffer)) - gUART_WriteIndex;
+		case UART_RX_SIZE_LO:
+			gUART_RxSize  = Byte;
+			gUART_RxState = UART_RX_SIZE_HI;
+			return false;
 
-		if (CommandLength < 8)
-			return 0;
+		case UART_RX_SIZE_HI:
+			gUART_RxSize |= Byte << 8;
+			gUART_RxCount = 0;
+			gUART_RxState = ((gUART_RxSize + 8u) > sizeof(UART_DMA_Buffer)) ? UART_RX_IDLE : UART_RX_PAYLOAD;
+			return false;
 
-		if (UART_DMA_Buffer[DMA_INDEX(gUART_WriteIndex, 1)] == 0xCD)
-			break;
+		case UART_RX_PAYLOAD:
+			if (gUART_RxCount < 2) {
+				UART_Command.Buffer[gUART_RxCount++] = Byte;
+				if (gUART_RxCount == 2) {
+					// the raw command ID switches the obfuscation on and off
+					gUART_RxEncrypted = bIsEncrypted;
+					if (UART_Command.Header.ID == 0x0514)
+						gUART_RxEncrypted = false;
+					if (UART_Command.Header.ID == 0x6902)
+						gUART_RxEncrypted = true;
+					if (gUART_RxEncrypted) {
+						UART_Command.Buffer[0] ^= Obfuscation[0];
+						UART_Command.Buffer[1] ^= Obfuscation[1];
+					}
+					gUART_RxCrc = CRC_Update(0, UART_Command.Buffer, (gUART_RxSize < 2) ? gUART_RxSize : 2);
+				}
+			} else {
+				const uint8_t Data = gUART_RxEncrypted ? Byte ^ Obfuscation[gUART_RxCount % 16] : Byte;
+				if (gUART_RxCount < gUART_RxSize)
+					gUART_RxCrc = CRC_UpdateByte(gUART_RxCrc, Data);
+				UART_Command.Buffer[gUART_RxCount++] = Data;
+			}
+			if (gUART_RxCount == gUART_RxSize + 2u)
+				gUART_RxState = UART_RX_END_1;
+			return false;
 
-		gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
-	}
+		case UART_RX_END_1:
+			gUART_RxState = (Byte == 0xDC) ? UART_RX_END_2 : UART_RX_IDLE;
+			return false;
 
-	Index = DMA_INDEX(gUART_WriteIndex, 2);
-	Size  = (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8) | UART_DMA_Buffer[Index];
+		case UART_RX_END_2:
+		{
+			gUART_RxState = UART_RX_IDLE;
+			if (Byte != 0xBA)
+				return false;
 
-	if ((Size + 8u) > sizeof(UART_DMA_Buffer))
-	{
-		gUART_WriteIndex = DmaLength;
-		return false;
-	}
+			const uint16_t Size = gUART_RxSize;
+			const uint16_t CRC  = UART_Command.Buffer[Size] | (UART_Command.Buffer[Size + 1] << 8);
+			if (gUART_RxCrc != CRC)
+				return false;
 
-	if (CommandLength < (Size + 8))
-		return false;
+			bIsEncrypted = gUART_RxEncrypted;
+			return true;
+		}
 
-	Index     = DMA_INDEX(Index, 2);
-	TailIndex = DMA_INDEX(Index, Size + 2);
+#if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+		case UART_RX_TEXT_PREFIX:
+			if (Byte == "SMS:"[gUART_RxCount]) {
+				if (++gUART_RxCount == 4) {
+					gUART_RxCount = 0;
+					gUART_RxState = UART_RX_TEXT;
+				}
+				return false;
+			}
+			break;
 
-	if (UART_DMA_Buffer[TailIndex] != 0xDC || UART_DMA_Buffer[DMA_INDEX(TailIndex, 1)] != 0xBA)
-	{
-		gUART_WriteIndex = DmaLength;
-		return false;
+		case UART_RX_TEXT:
+			if (Byte == '\n') {
+				UART_HandleTextLine();
+				gUART_RxState = UART_RX_IDLE;
+			}
+			else if (Byte != '\r' && gUART_RxCount < sizeof(gUART_TextLine) - 1) {
+				gUART_TextLine[gUART_RxCount++] = Byte;
+			}
+			return false;
+#endif
 	}
 
-	if (TailIndex < Index)
-	{
-		const uint16_t ChunkSize = sizeof(UART_DMA_Buffer) - Index;
-		memcpy(UART_Command.Buffer, UART_DMA_Buffer + Index, ChunkSize);
-		memcpy(UART_Command.Buffer + ChunkSize, UART_DMA_Buffer, TailIndex);
-	}
-	else
-		memcpy(UART_Command.Buffer, UART_DMA_Buffer + Index, TailIndex - Index);
+	gUART_RxState = UART_RX_IDLE;
 
-	TailIndex = DMA_INDEX(TailIndex, 2);
-	if (TailIndex < gUART_WriteIndex)
-	{
-		memset(UART_DMA_Buffer + gUART_WriteIndex, 0, sizeof(UART_DMA_Buffer) - gUART_WriteIndex);
-		memset(UART_DMA_Buffer, 0, TailIndex);
+	if (Byte == 0xAB)
+		gUART_RxState = UART_RX_START;
+#if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+	else if (Byte == 'S') {
+		gUART_RxCount = 1;
+		gUART_RxState = UART_RX_TEXT_PREFIX;
 	}
-	else
-		memset(UART_DMA_Buffer + gUART_WriteIndex, 0, TailIndex - gUART_WriteIndex);
-
-	gUART_WriteIndex = TailIndex;
+#endif
 
-	if (UART_Command.Header.ID == 0x0514)
-		bIsEncrypted = false;
+	return false;
+}
 
-	if (UART_Command.Header.ID == 0x6902)
-		bIsEncrypted = true;
+bool UART_IsCommandAvailable(void)
+{
+	const uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
 
-	if (bIsEncrypted)
+	while (gUART_WriteIndex != DmaLength)
 	{
-		unsigned int i;
-		for (i = 0; i < (Size + 2u); i++)
-			UART_Command.Buffer[i] ^= Obfuscation[i % 16];
+		const uint8_t Byte = UART_DMA_Buffer[gUART_WriteIndex];
+		gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+
+		if (UART_ParseByte(Byte))
+			return true;
 	}
-	
-	CRC = UART_Command.Buffer[Size] | (UART_Command.Buffer[Size + 1] << 8);
 
-	return (CRC_Calculate(UART_Command.Buffer, Size) != CRC) ? false : true;
+	return false;
 }
 
 void UART_HandleCommand(void)
@@ -696,8 +1041,35 @@ void UART_HandleCommand(void)
 		case 0x052F:
 			CMD_052F(UART_Command.Buffer);
 			break;
+
+		case 0x0540:
+			CMD_0540(UART_Command.Buffer);
+			break;
+
+		case 0x0542:
+			CMD_0542(UART_Command.Buffer);
+			break;
+
+		case 0x0543:
+			CMD_0543(UART_Command.Buffer);
+			break;
+
+		case 0x05E1:
+			CMD_05E1(UART_Command.Buffer);
+			break;
+
+		case 0x05E3:
+			CMD_05E3();
+			break;
+
+#ifdef ENABLE_IDLE_SLEEP
+		case 0x05E5:
+			CMD_05E5();
+			break;
+#endif
 	
 		case 0x05DD: // reset
+			EEPROM_Flush();
 			#if defined(ENABLE_OVERLAY)
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -27,130 +27,127 @@
 #include "driver/system.h"
 #include "driver/systick.h"
 #include "functions.h"
+#include "helper/pt.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/ui.h"
 
 
 BEEP_Type_t gBeepToPlay = BEEP_NONE;
 
-void AUDIO_PlayBeep(BEEP_Type_t Beep)
-{
-
-	if (Beep != BEEP_880HZ_60MS_TRIPLE_BEEP &&
-	    Beep != BEEP_500HZ_60MS_DOUBLE_BEEP &&
-	    Beep != BEEP_440HZ_500MS &&
-	    Beep != BEEP_880HZ_200MS &&
-	    Beep != BEEP_880HZ_500MS &&
-	   !gEeprom.BEEP_CONTROL)
-		return;
-
-#ifdef ENABLE_AIRCOPY
-	if (gScreenToDisplay == DISPLAY_AIRCOPY)
-		return;
-#endif
-
-	if (gCurrentFunction == FUNCTION_RECEIVE)
-		return;
-
-	if (gCurrentFunction == FUNCTION_MONITOR)
-		return;
-
-#ifdef ENABLE_FMRADIO
-	if (gFmRadioMode)
-		BK1080_Mute(true);
-#endif
-
-	AUDIO_AudioPathOff();
-
-	if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode)
-		BK4819_RX_TurnOn();
-
-	SYSTEM_DelayMs(20);
+static PT_t        gBeepThread;
+static BEEP_Type_t gBeep;
+static uint16_t    gBeepToneConfig;
+static uint8_t     gBeepRepeats;
 
-	uint16_t ToneConfig = BK4819_ReadRegister(BK4819_REG_71);
-
-	uint16_t ToneFrequency;
+static uint16_t AUDIO_GetBeepFrequency(BEEP_Type_t Beep)
+{
 	switch (Beep)
 	{
 		default:
 		case BEEP_NONE:
-			ToneFrequency = 220;
-			break;
+			return 220;
 		case BEEP_1KHZ_60MS_OPTIONAL:
-			ToneFrequency = 1000;
-			break;
+			return 1000;
 		case BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL:
 		case BEEP_500HZ_60MS_DOUBLE_BEEP:
-			ToneFrequency = 500;
-			break;
+			return 500;
 		case BEEP_440HZ_40MS_OPTIONAL:
 		case BEEP_440HZ_500MS:
-			ToneFrequency = 440;
-			break;
+			return 440;
 		case BEEP_880HZ_40MS_OPTIONAL:
 		case BEEP_880HZ_60MS_TRIPLE_BEEP:
 		case BEEP_880HZ_200MS:
 		case BEEP_880HZ_500MS:
-			ToneFrequency = 880;
-			break;
+			return 880;
 	}
+}
 
-	BK4819_PlayTone(ToneFrequency, true);
-
-	SYSTEM_DelayMs(2);
-
-	AUDIO_AudioPathOn();
-
-	SYSTEM_DelayMs(60);
-
-	uint16_t Duration;
+// length of the last (or only) pip
+static uint16_t AUDIO_GetBeepDuration(BEEP_Type_t Beep)
+{
 	switch (Beep)
 	{
 		case BEEP_880HZ_60MS_TRIPLE_BEEP:
-			BK4819_ExitTxMute();
-			SYSTEM_DelayMs(60);
-			BK4819_EnterTxMute();
-			SYSTEM_DelayMs(20);
-			[[fallthrough]];
 		case BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL:
 		case BEEP_500HZ_60MS_DOUBLE_BEEP:
-			BK4819_ExitTxMute();
-			SYSTEM_DelayMs(60);
-			BK4819_EnterTxMute();
-			SYSTEM_DelayMs(20);
-			[[fallthrough]];
 		case BEEP_1KHZ_60MS_OPTIONAL:
-			BK4819_ExitTxMute();
-			Duration = 60;
-			break;
+			return 60;
 		case BEEP_880HZ_40MS_OPTIONAL:
 		case BEEP_440HZ_40MS_OPTIONAL:
-			BK4819_ExitTxMute();
-			Duration = 40;
-			break;
+			return 40;
 		case BEEP_880HZ_200MS:
-			BK4819_ExitTxMute();
-			Duration = 200;
-			break;
+			return 200;
 		case BEEP_440HZ_500MS:
 		case BEEP_880HZ_500MS:
 		default:
-			BK4819_ExitTxMute();
-			Duration = 500;
-			break;
+			return 500;
+	}
+}
+
+// pips played before the last one
+static uint8_t AUDIO_GetBeepRepeats(BEEP_Type_t Beep)
+{
+	switch (Beep)
+	{
+		case BEEP_880HZ_60MS_TRIPLE_BEEP:
+			return 2;
+		case BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL:
+		case BEEP_500HZ_60MS_DOUBLE_BEEP:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static bool AUDIO_BeepThread(void)
+{
+	PT_t *pt = &gBeepThread;
+
+	PT_BEGIN(pt);
+
+#ifdef ENABLE_FMRADIO
+	if (gFmRadioMode)
+		BK1080_Mute(true);
+#endif
+
+	AUDIO_AudioPathOff();
+
+	if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode)
+		BK4819_RX_TurnOn();
+
+	PT_DELAY_MS(pt, 20);
+
+	gBeepToneConfig = BK4819_ReadRegister(BK4819_REG_71);
+
+	BK4819_PlayTone(AUDIO_GetBeepFrequency(gBeep), true);
+
+	SYSTEM_DelayMs(2);
+
+	AUDIO_AudioPathOn();
+
+	PT_DELAY_MS(pt, 60);
+
+	for (gBeepRepeats = AUDIO_GetBeepRepeats(gBeep); gBeepRepeats > 0; gBeepRepeats--)
+	{
+		BK4819_ExitTxMute();
+		PT_DELAY_MS(pt, 60);
+		BK4819_EnterTxMute();
+		PT_DELAY_MS(pt, 20);
 	}
 
-	SYSTEM_DelayMs(Duration);
+	BK4819_ExitTxMute();
+	PT_DELAY_MS(pt, AUDIO_GetBeepDuration(gBeep));
 	BK4819_EnterTxMute();
-	SYSTEM_DelayMs(20);
+	PT_DELAY_MS(pt, 20);
 
 	AUDIO_AudioPathOff();
 
 	SYSTEM_DelayMs(5);
 	BK4819_TurnsOffTones_TurnsOnRX();
 	SYSTEM_DelayMs(5);
-	BK4819_WriteRegister(BK4819_REG_71, ToneConfig);
+	BK4819_WriteRegister(BK4819_REG_71, gBeepToneConfig);
 
 	if (gEnableSpeaker)
 		AUDIO_AudioPathOn();
@@ -167,6 +164,59 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep)
 	gVoxResumeCountdown = 80;
 #endif
 
+	PT_END(pt);
+}
+
+void AUDIO_PlayBeep(BEEP_Type_t Beep)
+{
+
+	if (Beep != BEEP_880HZ_60MS_TRIPLE_BEEP &&
+	    Beep != BEEP_500HZ_60MS_DOUBLE_BEEP &&
+	    Beep != BEEP_440HZ_500MS &&
+	    Beep != BEEP_880HZ_200MS &&
+	    Beep != BEEP_880HZ_500MS &&
+	   !gEeprom.BEEP_CONTROL)
+		return;
+
+#ifdef ENABLE_AIRCOPY
+	if (gScreenToDisplay == DISPLAY_AIRCOPY)
+		return;
+#endif
+
+	if (gCurrentFunction == FUNCTION_RECEIVE)
+		return;
+
+	if (gCurrentFunction == FUNCTION_MONITOR)
+		return;
+
+	// one beep at a time, the previous one plays out first
+	AUDIO_FinishBeep();
+
+	gBeep = Beep;
+	PT_INIT(&gBeepThread);
+	AUDIO_BeepThread();
+}
+
+// resumes the beep in progress, called every 10ms
+void AUDIO_ServiceBeep(void)
+{
+	if (PT_IsRunning(&gBeepThread))
+		AUDIO_BeepThread();
+}
+
+// plays the rest of the beep in place, for code about to reprogram the BK4819
+void AUDIO_FinishBeep(void)
+{
+	if (!PT_IsRunning(&gBeepThread))
+		return;
+
+	gBeepThread.bBlocking = true;
+	AUDIO_BeepThread();
+}
+
+bool AUDIO_IsBeeping(void)
+{
+	return PT_IsRunning(&gBeepThread);
 }
 
 #ifdef ENABLE_VOICE
@@ -200,7 +250,6 @@ static const uint8_t VoiceClipLengthEnglish[76] =
 VOICE_ID_t        gVoiceID[8];
 uint8_t           gVoiceReadIndex;
 uint8_t           gVoiceWriteIndex;
-volatile uint16_t gCountdownToPlayNextVoice_10ms;
 volatile bool     gFlagPlayQueuedVoice;
 VOICE_ID_t        gAnotherVoiceID = VOICE_ID_INVALID;
 
@@ -209,6 +258,8 @@ static void AUDIO_PlayVoice(uint8_t VoiceID)
 {
 	unsigned int i;
 
+	AUDIO_FinishBeep();   // they share the audio path
+
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_VOICE_0);
 	SYSTEM_DelayMs(20);
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_VOICE_0);
@@ -301,7 +352,7 @@ void AUDIO_PlaySingleVoice(bool bFlag)
 		}
 
 		gVoiceReadIndex                = 1;
-		gCountdownToPlayNextVoice_10ms = Delay;
+		TIMER_Start(TIMER_VOICE, Delay);
 		gFlagPlayQueuedVoice           = false;
 
 		return;
@@ -407,7 +458,7 @@ void AUDIO_PlayQueuedVoice(void)
 
 			AUDIO_PlayVoice(VoiceID);
 
-			gCountdownToPlayNextVoice_10ms = Delay;
+			TIMER_Start(TIMER_VOICE, Delay);
 			gFlagPlayQueuedVoice           = false;
 
 			#ifdef ENABLE_VOX
@@ -42,6 +42,9 @@ typedef enum BEEP_Type_t BEEP_Type_t;
 extern BEEP_Type_t       gBeepToPlay;
 
 void AUDIO_PlayBeep(BEEP_Type_t Beep);
+void AUDIO_ServiceBeep(void);
+void AUDIO_FinishBeep(void);
+bool AUDIO_IsBeeping(void);
 
 enum
 {
@@ -145,7 +148,6 @@ static inline void AUDIO_AudioPathOff(void) {
 	extern VOICE_ID_t        gVoiceID[8];
 	extern uint8_t           gVoiceReadIndex;
 	extern uint8_t           gVoiceWriteIndex;
-	extern volatile uint16_t gCountdownToPlayNextVoice_10ms;
 	extern volatile bool     gFlagPlayQueuedVoice;
 	extern VOICE_ID_t        gAnotherVoiceID;
 	
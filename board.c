@@ -454,6 +454,17 @@ void BOARD_PORTCON_Init(void)
 		;
 }
 
+static uint16_t          gAdcVoltages[BOARD_ADC_WINDOW];
+static uint32_t          gAdcVoltageSum;
+static uint8_t           gAdcIndex;
+static uint8_t           gAdcTick_10ms;
+static bool              gAdcRunning;
+
+// published snapshot, gAdcSequence changes whenever the tick updates it
+static volatile uint8_t  gAdcSequence;
+static volatile uint16_t gAdcVoltage;
+static volatile uint16_t gAdcCurrent;
+
 void BOARD_ADC_Init(void)
 {
 	ADC_Config_t Config;
@@ -477,14 +488,67 @@ void BOARD_ADC_Init(void)
 	ADC_Configure(&Config);
 	ADC_Enable();
 	ADC_SoftReset();
+
+	// fill the window once so the first readings are already settled
+	ADC_Start();
+	while (!ADC_CheckEndOfConversion(ADC_CH9)) {}
+	gAdcVoltage = ADC_GetValue(ADC_CH4);
+	gAdcCurrent = ADC_GetValue(ADC_CH9);
+
+	for (unsigned int i = 0; i < BOARD_ADC_WINDOW; i++)
+		gAdcVoltages[i] = gAdcVoltage;
+	gAdcVoltageSum = gAdcVoltage * BOARD_ADC_WINDOW;
+
+	gAdcTick_10ms = BOARD_ADC_PERIOD_10ms;
+	gAdcRunning   = true;
+	ADC_Start();
 }
 
-void BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent)
+// called from the 10ms tick, picks up the finished conversion and starts the next one
+void BOARD_ADC_Service(bool bSampleVoltage)
 {
+	uint16_t Voltage;
+
+	if (!gAdcRunning)
+		return;
+
+	if (gAdcTick_10ms > 0 && --gAdcTick_10ms > 0)
+		return;
+
+	if (!ADC_CheckEndOfConversion(ADC_CH9))
+		return;
+
+	gAdcTick_10ms = BOARD_ADC_PERIOD_10ms;
+
+	Voltage = ADC_GetValue(ADC_CH4);
+
+	gAdcSequence++;
+
+	gAdcCurrent = ADC_GetValue(ADC_CH9);
+
+	// the voltage sags while transmitting, keep those samples out of the average
+	if (bSampleVoltage) {
+		gAdcVoltageSum += Voltage - gAdcVoltages[gAdcIndex];
+		gAdcVoltages[gAdcIndex] = Voltage;
+		gAdcIndex = (gAdcIndex + 1) % BOARD_ADC_WINDOW;
+		gAdcVoltage = gAdcVoltageSum / BOARD_ADC_WINDOW;
+	}
+
+	gAdcSequence++;
+
 	ADC_Start();
-	while (!ADC_CheckEndOfConversion(ADC_CH9)) {}
-	*pVoltage = ADC_GetValue(ADC_CH4);
-	*pCurrent = ADC_GetValue(ADC_CH9);
+}
+
+// never waits on the ADC, returns the averaged voltage and the latest current
+void BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent)
+{
+	uint8_t Sequence;
+
+	do {
+		Sequence  = gAdcSequence;
+		*pVoltage = gAdcVoltage;
+		*pCurrent = gAdcCurrent;
+	} while (Sequence != gAdcSequence);
 }
 
 void BOARD_Init(void)
@@ -20,10 +20,16 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// the battery voltage is averaged over BOARD_ADC_WINDOW conversions,
+// one conversion every BOARD_ADC_PERIOD_10ms ticks (1.6 sec total)
+#define BOARD_ADC_WINDOW       16U
+#define BOARD_ADC_PERIOD_10ms  10U
+
 void     BOARD_FLASH_Init(void);
 void     BOARD_GPIO_Init(void);
 void     BOARD_PORTCON_Init(void);
 void     BOARD_ADC_Init(void);
+void     BOARD_ADC_Service(bool bSampleVoltage);
 void     BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent);
 void     BOARD_Init(void);
 
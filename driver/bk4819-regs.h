@@ -103,6 +103,7 @@ enum BK4819_REGISTER_t {
 	BK4819_REG_63 = 0x63U,
 	BK4819_REG_64 = 0x64U,
 	BK4819_REG_65 = 0x65U,
+	BK4819_REG_66 = 0x66U,
 	BK4819_REG_67 = 0x67U,
 	BK4819_REG_68 = 0x68U,
 	BK4819_REG_69 = 0x69U,
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>   // NULL
+#include <string.h>
 
 #include "audio.h"
 #include "bk4819.h"
@@ -31,11 +32,23 @@
 
 //static const uint16_t FSK_RogerTable[7] = {0xF1A2, 0x7446, 0x61A4, 0x6544, 0x4E8A, 0xE044, 0xEA84};
 
+// SPI edge timing in ns, keeps SCL under 2MHz with plenty of margin.
+// SDA is changed right after the falling edge so the low half doubles as
+// data setup time on writes and as output valid time on reads
+#define BK4819_T_HIGH_NS  250
+#define BK4819_T_LOW_NS   250
+#define BK4819_T_SCN_NS   500   // SCN setup/hold and gap between frames
+
 static const uint8_t DTMF_TONE1_GAIN = 65;
 static const uint8_t DTMF_TONE2_GAIN = 93;
 
 static uint16_t gBK4819_GpioOutState;
 
+// RAM copy of the BK4819 register file, saves a bit-banged SPI read on
+// every read-modify-write and lets us drop writes that change nothing
+static uint16_t gBK4819_RegShadow[128];
+static uint32_t gBK4819_RegShadowValid[128 / 32];
+
 bool gRxIdleMode;
 
 __inline uint16_t scale_freq(const uint16_t freq)
@@ -44,24 +57,11 @@ __inline uint16_t scale_freq(const uint16_t freq)
 	return (((uint32_t)freq * 1353245u) + (1u << 16)) >> 17;   // with rounding
 }
 
-void BK4819_Init(void)
+static const BK4819_RegPair_t BK4819_InitTable[] =
 {
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
-
-	BK4819_WriteRegister(BK4819_REG_00, 0x8000);
-	BK4819_WriteRegister(BK4819_REG_00, 0x0000);
-
-	BK4819_WriteRegister(BK4819_REG_37, 0x1D0F);
-	BK4819_WriteRegister(BK4819_REG_36, 0x0022);
+	{BK4819_REG_19, 0b0001000001000001},   // <15> MIC AGC  1 = disable  0 = enable
 
-	BK4819_InitAGC();
-	BK4819_SetAGC(true);
-
-	BK4819_WriteRegister(BK4819_REG_19, 0b0001000001000001);   // <15> MIC AGC  1 = disable  0 = enable
-
-	BK4819_WriteRegister(BK4819_REG_7D, 0xE940);
+	{BK4819_REG_7D, 0xE940},
 
 	// REG_48 .. RX AF level
 	//
@@ -81,43 +81,55 @@ void BK4819_Init(void)
 	//         15 = max
 	//          0 = min
 	//
-	BK4819_WriteRegister(BK4819_REG_48,	//  0xB3A8);     // 1011 00 111010 1000
+	{BK4819_REG_48,	//  0xB3A8,     // 1011 00 111010 1000
 		(11u << 12) |     // ??? 0..15
 		( 0u << 10) |     // AF Rx Gain-1
 		(58u <<  4) |     // AF Rx Gain-2
-		( 8u <<  0));     // AF DAC Gain (after Gain-1 and Gain-2)
-
-#if 1
-	const uint8_t dtmf_coeffs[] = {111, 107, 103, 98, 80, 71, 58, 44, 65, 55, 37, 23, 228, 203, 181, 159};
-	for (unsigned int i = 0; i < ARRAY_SIZE(dtmf_coeffs); i++)
-		BK4819_WriteRegister(BK4819_REG_09, (i << 12) | dtmf_coeffs[i]);
-#else
-	// original code
-	BK4819_WriteRegister(BK4819_REG_09, 0x006F);  // 6F
-	BK4819_WriteRegister(BK4819_REG_09, 0x106B);  // 6B
-	BK4819_WriteRegister(BK4819_REG_09, 0x2067);  // 67
-	BK4819_WriteRegister(BK4819_REG_09, 0x3062);  // 62
-	BK4819_WriteRegister(BK4819_REG_09, 0x4050);  // 50
-	BK4819_WriteRegister(BK4819_REG_09, 0x5047);  // 47
-	BK4819_WriteRegister(BK4819_REG_09, 0x603A);  // 3A
-	BK4819_WriteRegister(BK4819_REG_09, 0x702C);  // 2C
-	BK4819_WriteRegister(BK4819_REG_09, 0x8041);  // 41
-	BK4819_WriteRegister(BK4819_REG_09, 0x9037);  // 37
-	BK4819_WriteRegister(BK4819_REG_09, 0xA025);  // 25
-	BK4819_WriteRegister(BK4819_REG_09, 0xB017);  // 17
-	BK4819_WriteRegister(BK4819_REG_09, 0xC0E4);  // E4
-	BK4819_WriteRegister(BK4819_REG_09, 0xD0CB);  // CB
-	BK4819_WriteRegister(BK4819_REG_09, 0xE0B5);  // B5
-	BK4819_WriteRegister(BK4819_REG_09, 0xF09F);  // 9F
-#endif
+		( 8u <<  0)},     // AF DAC Gain (after Gain-1 and Gain-2)
+
+	// DTMF coefficients, index in <15:12>
+	{BK4819_REG_09, 0x006F},  // 6F
+	{BK4819_REG_09, 0x106B},  // 6B
+	{BK4819_REG_09, 0x2067},  // 67
+	{BK4819_REG_09, 0x3062},  // 62
+	{BK4819_REG_09, 0x4050},  // 50
+	{BK4819_REG_09, 0x5047},  // 47
+	{BK4819_REG_09, 0x603A},  // 3A
+	{BK4819_REG_09, 0x702C},  // 2C
+	{BK4819_REG_09, 0x8041},  // 41
+	{BK4819_REG_09, 0x9037},  // 37
+	{BK4819_REG_09, 0xA025},  // 25
+	{BK4819_REG_09, 0xB017},  // 17
+	{BK4819_REG_09, 0xC0E4},  // E4
+	{BK4819_REG_09, 0xD0CB},  // CB
+	{BK4819_REG_09, 0xE0B5},  // B5
+	{BK4819_REG_09, 0xF09F},  // 9F
+
+	{BK4819_REG_1F, 0x5454},
+	{BK4819_REG_3E, 0xA037},
+
+	{BK4819_REG_33, 0x9000},   // GPIO out, keep in step with gBK4819_GpioOutState
+	{BK4819_REG_3F, 0},
+};
 
-	BK4819_WriteRegister(BK4819_REG_1F, 0x5454);
-	BK4819_WriteRegister(BK4819_REG_3E, 0xA037);
+void BK4819_Init(void)
+{
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+
+	BK4819_WriteRegister(BK4819_REG_00, 0x8000);
+	BK4819_WriteRegister(BK4819_REG_00, 0x0000);
+
+	BK4819_WriteRegister(BK4819_REG_37, 0x1D0F);
+	BK4819_WriteRegister(BK4819_REG_36, 0x0022);
+
+	BK4819_InitAGC();
+	BK4819_SetAGC(true);
 
 	gBK4819_GpioOutState = 0x9000;
 
-	BK4819_WriteRegister(BK4819_REG_33, 0x9000);
-	BK4819_WriteRegister(BK4819_REG_3F, 0);
+	BK4819_WriteRegisters(BK4819_InitTable, ARRAY_SIZE(BK4819_InitTable));
 }
 
 static uint16_t BK4819_ReadU16(void)
@@ -127,7 +139,7 @@ static uint16_t BK4819_ReadU16(void)
 
 	PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_ENABLE;
 	GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_INPUT;
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(BK4819_T_LOW_NS);
 
 	Value = 0;
 	for (i = 0; i < 16; i++)
@@ -135,9 +147,9 @@ static uint16_t BK4819_ReadU16(void)
 		Value <<= 1;
 		Value |= GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_HIGH_NS);
 		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_LOW_NS);
 	}
 	PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_DISABLE;
 	GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_OUTPUT;
@@ -145,21 +157,53 @@ static uint16_t BK4819_ReadU16(void)
 	return Value;
 }
 
-uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
+// registers the chip updates on its own (status, RSSI, FIFO ..) or that act
+// as strobes/indexed ports, these must always go out to the chip
+static bool BK4819_IsVolatileRegister(BK4819_REGISTER_t Register)
+{
+	switch (Register)
+	{
+		case BK4819_REG_00:   // soft reset
+		case BK4819_REG_02:   // interrupt status
+		case BK4819_REG_06:   // indexed AGC table port
+		case BK4819_REG_09:   // indexed DTMF coefficient port
+		case BK4819_REG_0B:   // DTMF/FSK status
+		case BK4819_REG_0C:   // interrupt request, CTC/CDCSS status
+		case BK4819_REG_0D:   // frequency scan result
+		case BK4819_REG_0E:
+		case BK4819_REG_59:   // FSK control, FIFO clear bits self-reset
+		case BK4819_REG_5F:   // FSK FIFO
+		case BK4819_REG_63:   // glitch indicator
+		case BK4819_REG_64:   // voice amplitude
+		case BK4819_REG_65:   // ex-noise indicator
+		case BK4819_REG_66:
+		case BK4819_REG_67:   // RSSI
+		case BK4819_REG_68:   // CTC/CDCSS scan results
+		case BK4819_REG_69:
+		case BK4819_REG_6A:
+		case BK4819_REG_6F:   // AF TX/RX level
+		case BK4819_REG_7E:   // AGC gain index/signal strength read back
+			return true;
+		default:
+			return false;
+	}
+}
+
+static uint16_t BK4819_ReadRegisterFromChip(BK4819_REGISTER_t Register)
 {
 	uint16_t Value;
 
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
 
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	BK4819_WriteU8(Register | 0x80);
 	Value = BK4819_ReadU16();
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
 
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
@@ -167,25 +211,94 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 	return Value;
 }
 
-void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
+{
+	const unsigned int reg  = Register & 0x7F;
+	const uint32_t     mask = 1u << (reg & 31);
+
+	if (BK4819_IsVolatileRegister(Register))
+		return BK4819_ReadRegisterFromChip(Register);
+
+	if ((gBK4819_RegShadowValid[reg >> 5] & mask) == 0) {
+		gBK4819_RegShadow[reg] = BK4819_ReadRegisterFromChip(Register);
+		gBK4819_RegShadowValid[reg >> 5] |= mask;
+	}
+
+	return gBK4819_RegShadow[reg];
+}
+
+static void BK4819_WriteRegisterToChip(BK4819_REGISTER_t Register, uint16_t Data)
 {
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
 
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	BK4819_WriteU8(Register);
+	BK4819_WriteU16(Data);
 
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
 
-	BK4819_WriteU16(Data);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
+
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+}
 
-	SYSTICK_DelayUs(1);
+// keeps the shadow up to date, returns false if the chip already holds Data
+static bool BK4819_ShadowWrite(BK4819_REGISTER_t Register, uint16_t Data)
+{
+	const unsigned int reg  = Register & 0x7F;
+	const uint32_t     mask = 1u << (reg & 31);
+
+	if (BK4819_IsVolatileRegister(Register)) {
+		if (Register == BK4819_REG_00)   // soft reset puts every register back to its default
+			memset(gBK4819_RegShadowValid, 0, sizeof(gBK4819_RegShadowValid));
+		return true;
+	}
 
+	if ((gBK4819_RegShadowValid[reg >> 5] & mask) && gBK4819_RegShadow[reg] == Data)
+		return false;
+
+	gBK4819_RegShadow[reg] = Data;
+	gBK4819_RegShadowValid[reg >> 5] |= mask;
+
+	return true;
+}
+
+void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+{
+	if (BK4819_ShadowWrite(Register, Data))
+		BK4819_WriteRegisterToChip(Register, Data);
+}
+
+// writes a whole sequence back to back, the bus is only returned to idle
+// at the end and SCN is the only line toggled between frames
+void BK4819_WriteRegisters(const BK4819_RegPair_t *pList, size_t Count)
+{
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+
+	SYSTICK_DelayNs(BK4819_T_SCN_NS);
 
-	SYSTICK_DelayUs(1);
+	for (; Count > 0; Count--, pList++)
+	{
+		if (!BK4819_ShadowWrite(pList->Register, pList->Value))
+			continue;
+
+		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+		BK4819_WriteU8(pList->Register);
+		BK4819_WriteU16(pList->Value);
+
+		SYSTICK_DelayNs(BK4819_T_SCN_NS);
+
+		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+
+		SYSTICK_DelayNs(BK4819_T_SCN_NS);
+	}
 
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
@@ -203,14 +316,13 @@ void BK4819_WriteU8(uint8_t Data)
 		else
 			GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_LOW_NS);
 		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_HIGH_NS);
 
 		Data <<= 1;
 
 		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
 	}
 }
 
@@ -226,14 +338,13 @@ void BK4819_WriteU16(uint16_t Data)
 		else
 			GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_LOW_NS);
 		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
 		Data <<= 1;
 
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(BK4819_T_HIGH_NS);
 		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
 	}
 }
 
@@ -305,20 +416,23 @@ void BK4819_InitAGC()
 	//         0 = -33dB
 	//
 
-	BK4819_SetDefaultAmplifierSettings();         // 0x03BE / 000000 11 101 11 110 /  -7dB
-
-	BK4819_WriteRegister(BK4819_REG_12, 0x037B);  // 0x037B / 000000 11 011 11 011 / -24dB
-	BK4819_WriteRegister(BK4819_REG_11, 0x027B);  // 0x027B / 000000 10 011 11 011 / -43dB
-	BK4819_WriteRegister(BK4819_REG_10, 0x007A);  // 0x007A / 000000 00 011 11 010 / -58dB
-	BK4819_WriteRegister(BK4819_REG_14, 0x0019);  // 0x0019 / 000000 00 000 11 001 / -79dB
-	//30, 10 - doesn't overload but sound low
-	//50, 10 - best so far
-	//50, 15, - SOFT - signal doesn't fall too low - works best for now
-	//45, 25 - AGRESSIVE - lower histeresis, but volume jumps heavily, not good for music, might be good for aviation
-	//1 << 14 - way better, seems to open squelch and match squelch as opposed to 0
-	BK4819_WriteRegister(BK4819_REG_49, (0b00 << 14) | (50 << 7) | (15 << 0)); //0x2A38 / 00 1010100 0111000 / 84, 56
-	BK4819_WriteRegister(BK4819_REG_7B, 0x8420);
+	static const BK4819_RegPair_t agc_table[] =
+	{
+		{BK4819_REG_13, 0x03BE},  // 0x03BE / 000000 11 101 11 110 /  -7dB, same as BK4819_SetDefaultAmplifierSettings()
+		{BK4819_REG_12, 0x037B},  // 0x037B / 000000 11 011 11 011 / -24dB
+		{BK4819_REG_11, 0x027B},  // 0x027B / 000000 10 011 11 011 / -43dB
+		{BK4819_REG_10, 0x007A},  // 0x007A / 000000 00 011 11 010 / -58dB
+		{BK4819_REG_14, 0x0019},  // 0x0019 / 000000 00 000 11 001 / -79dB
+		//30, 10 - doesn't overload but sound low
+		//50, 10 - best so far
+		//50, 15, - SOFT - signal doesn't fall too low - works best for now
+		//45, 25 - AGRESSIVE - lower histeresis, but volume jumps heavily, not good for music, might be good for aviation
+		//1 << 14 - way better, seems to open squelch and match squelch as opposed to 0
+		{BK4819_REG_49, (0b00 << 14) | (50 << 7) | (15 << 0)}, //0x2A38 / 00 1010100 0111000 / 84, 56
+		{BK4819_REG_7B, 0x8420},
+	};
 
+	BK4819_WriteRegisters(agc_table, ARRAY_SIZE(agc_table));
 }
 
 
@@ -598,75 +712,81 @@ void BK4819_SetupSquelch(
 		uint8_t SquelchCloseGlitchThresh,
 		uint8_t SquelchOpenGlitchThresh)
 {
-	// REG_70
-	//
-	// <15>   0 Enable TONE1
-	//        1 = Enable
-	//        0 = Disable
-	//
-	// <14:8> 0 TONE1 tuning gain
-	//        0 ~ 127
-	//
-	// <7>    0 Enable TONE2
-	//        1 = Enable
-	//        0 = Disable
-	//
-	// <6:0>  0 TONE2/FSK tuning gain
-	//        0 ~ 127
-	//
-	BK4819_WriteRegister(BK4819_REG_70, 0);
+	const BK4819_RegPair_t squelch_table[] =
+	{
+		// REG_70
+		//
+		// <15>   0 Enable TONE1
+		//        1 = Enable
+		//        0 = Disable
+		//
+		// <14:8> 0 TONE1 tuning gain
+		//        0 ~ 127
+		//
+		// <7>    0 Enable TONE2
+		//        1 = Enable
+		//        0 = Disable
+		//
+		// <6:0>  0 TONE2/FSK tuning gain
+		//        0 ~ 127
+		//
+		{BK4819_REG_70, 0},
 
-	// Glitch threshold for Squelch = close
-	//
-	// 0 ~ 255
-	//
-	BK4819_WriteRegister(BK4819_REG_4D, 0xA000 | SquelchCloseGlitchThresh);
+		// Glitch threshold for Squelch = close
+		//
+		// 0 ~ 255
+		//
+		{BK4819_REG_4D, 0xA000 | SquelchCloseGlitchThresh},
 
-	// REG_4E
-	//
-	// <15:14> 1 ???
-	//
-	// <13:11> 5 Squelch = open  Delay Setting
-	//         0 ~ 7
-	//
-	// <10:9>  7 Squelch = close Delay Setting
-	//         0 ~ 3
-	//
-	// <8>     0 ???
-	//
-	// <7:0>   8 Glitch threshold for Squelch = open
-	//         0 ~ 255
-	//
-	BK4819_WriteRegister(BK4819_REG_4E,  // 01 101 11 1 00000000
+		// REG_4E
+		//
+		// <15:14> 1 ???
+		//
+		// <13:11> 5 Squelch = open  Delay Setting
+		//         0 ~ 7
+		//
+		// <10:9>  7 Squelch = close Delay Setting
+		//         0 ~ 3
+		//
+		// <8>     0 ???
+		//
+		// <7:0>   8 Glitch threshold for Squelch = open
+		//         0 ~ 255
+		//
+		{BK4819_REG_4E,  // 01 101 11 1 00000000
 
-		// original (*)
-	(1u << 14) |                  //  1 ???
-	(5u << 11) |                  // *5  squelch = open  delay .. 0 ~ 7
-	(6u <<  9) |                  // *3  squelch = close delay .. 0 ~ 3
-	SquelchOpenGlitchThresh);     //  0 ~ 255
+			// original (*)
+		(1u << 14) |                  //  1 ???
+		(5u << 11) |                  // *5  squelch = open  delay .. 0 ~ 7
+		(6u <<  9) |                  // *3  squelch = close delay .. 0 ~ 3
+		SquelchOpenGlitchThresh},     //  0 ~ 255
 
 
-	// REG_4F
-	//
-	// <14:8> 47 Ex-noise threshold for Squelch = close
-	//        0 ~ 127
-	//
-	// <7>    ???
-	//
-	// <6:0>  46 Ex-noise threshold for Squelch = open
-	//        0 ~ 127
-	//
-	BK4819_WriteRegister(BK4819_REG_4F, ((uint16_t)SquelchCloseNoiseThresh << 8) | SquelchOpenNoiseThresh);
+		// REG_4F
+		//
+		// <14:8> 47 Ex-noise threshold for Squelch = close
+		//        0 ~ 127
+		//
+		// <7>    ???
+		//
+		// <6:0>  46 Ex-noise threshold for Squelch = open
+		//        0 ~ 127
+		//
+		{BK4819_REG_4F, ((uint16_t)SquelchCloseNoiseThresh << 8) | SquelchOpenNoiseThresh},
 
-	// REG_78
-	//
-	// <15:8> 72 RSSI threshold for Squelch = open    0.5dB/step
-	//
-	// <7:0>  70 RSSI threshold for Squelch = close   0.5dB/step
-	//
-	BK4819_WriteRegister(BK4819_REG_78, ((uint16_t)SquelchOpenRSSIThresh   << 8) | SquelchCloseRSSIThresh);
+		// REG_78
+		//
+		// <15:8> 72 RSSI threshold for Squelch = open    0.5dB/step
+		//
+		// <7:0>  70 RSSI threshold for Squelch = close   0.5dB/step
+		//
+		{BK4819_REG_78, ((uint16_t)SquelchOpenRSSIThresh   << 8) | SquelchCloseRSSIThresh},
 
-	BK4819_SetAF(BK4819_AF_MUTE);
+		// same as BK4819_SetAF(BK4819_AF_MUTE)
+		{BK4819_REG_47, (6u << 12) | (BK4819_AF_MUTE << 8) | (1u << 6)},
+	};
+
+	BK4819_WriteRegisters(squelch_table, ARRAY_SIZE(squelch_table));
 
 	BK4819_RX_TurnOn();
 }
@@ -696,37 +816,41 @@ void BK4819_SetRegValue(RegisterSpec s, uint16_t v) {
 
 void BK4819_RX_TurnOn(void)
 {
-	// DSP Voltage Setting = 1
-	// ANA LDO = 2.7v
-	// VCO LDO = 2.7v
-	// RF LDO  = 2.7v
-	// PLL LDO = 2.7v
-	// ANA LDO bypass
-	// VCO LDO bypass
-	// RF LDO  bypass
-	// PLL LDO bypass
-	// Reserved bit is 1 instead of 0
-	// Enable  DSP
-	// Enable  XTAL
-	// Enable  Band Gap
-	//
-	BK4819_WriteRegister(BK4819_REG_37, 0x1F0F);  // 0001111100001111
-
-	// Turn off everything
-	BK4819_WriteRegister(BK4819_REG_30, 0);
+	static const BK4819_RegPair_t rx_on_table[] =
+	{
+		// DSP Voltage Setting = 1
+		// ANA LDO = 2.7v
+		// VCO LDO = 2.7v
+		// RF LDO  = 2.7v
+		// PLL LDO = 2.7v
+		// ANA LDO bypass
+		// VCO LDO bypass
+		// RF LDO  bypass
+		// PLL LDO bypass
+		// Reserved bit is 1 instead of 0
+		// Enable  DSP
+		// Enable  XTAL
+		// Enable  Band Gap
+		//
+		{BK4819_REG_37, 0x1F0F},  // 0001111100001111
 
+		// Turn off everything
+		{BK4819_REG_30, 0},
 
-	BK4819_WriteRegister(BK4819_REG_30, 
-		BK4819_REG_30_ENABLE_VCO_CALIB |
-		BK4819_REG_30_DISABLE_UNKNOWN |
-		BK4819_REG_30_ENABLE_RX_LINK |
-		BK4819_REG_30_ENABLE_AF_DAC |
-		BK4819_REG_30_ENABLE_DISC_MODE |
-		BK4819_REG_30_ENABLE_PLL_VCO |
-		BK4819_REG_30_DISABLE_PA_GAIN |
-		BK4819_REG_30_DISABLE_MIC_ADC |
-		BK4819_REG_30_DISABLE_TX_DSP |
-		BK4819_REG_30_ENABLE_RX_DSP );
+		{BK4819_REG_30,
+			BK4819_REG_30_ENABLE_VCO_CALIB |
+			BK4819_REG_30_DISABLE_UNKNOWN |
+			BK4819_REG_30_ENABLE_RX_LINK |
+			BK4819_REG_30_ENABLE_AF_DAC |
+			BK4819_REG_30_ENABLE_DISC_MODE |
+			BK4819_REG_30_ENABLE_PLL_VCO |
+			BK4819_REG_30_DISABLE_PA_GAIN |
+			BK4819_REG_30_DISABLE_MIC_ADC |
+			BK4819_REG_30_DISABLE_TX_DSP |
+			BK4819_REG_30_ENABLE_RX_DSP},
+	};
+
+	BK4819_WriteRegisters(rx_on_table, ARRAY_SIZE(rx_on_table));
 }
 
 void BK4819_PickRXFilterPathBasedOnFrequency(uint32_t Frequency)
@@ -894,8 +1018,10 @@ void BK4819_PlayTone(uint16_t Frequency, bool bTuningGainSwitch)
 }
 
 // level 0 ~ 127
-void BK4819_PlaySingleTone(const unsigned int tone_Hz, const unsigned int delay, const unsigned int level, const bool play_speaker)
+bool BK4819_PlaySingleTone(PT_t *pt, const unsigned int tone_Hz, const unsigned int delay, const unsigned int level, const bool play_speaker)
 {
+	PT_BEGIN(pt);
+
 	BK4819_EnterTxMute();
 	
 	if (play_speaker)
@@ -910,12 +1036,12 @@ void BK4819_PlaySingleTone(const unsigned int tone_Hz, const unsigned int delay,
 	BK4819_WriteRegister(BK4819_REG_70, BK4819_REG_70_ENABLE_TONE1 | ((level & 0x7f) << BK4819_REG_70_SHIFT_TONE1_TUNING_GAIN));
 
 	BK4819_EnableTXLink();
-	SYSTEM_DelayMs(50);
+	PT_DELAY_MS(pt, 50);
 
 	BK4819_WriteRegister(BK4819_REG_71, scale_freq(tone_Hz));
 
 	BK4819_ExitTxMute();
-	SYSTEM_DelayMs(delay);
+	PT_DELAY_MS(pt, delay);
 	BK4819_EnterTxMute();
 
 	if (play_speaker)
@@ -927,6 +1053,8 @@ void BK4819_PlaySingleTone(const unsigned int tone_Hz, const unsigned int delay,
 	BK4819_WriteRegister(BK4819_REG_70, 0x0000);
 	BK4819_WriteRegister(BK4819_REG_30, 0xC1FE);
 	BK4819_ExitTxMute();
+
+	PT_END(pt);
 }
 
 void BK4819_EnterTxMute(void)
@@ -965,12 +1093,17 @@ void BK4819_TurnsOffTones_TurnsOnRX(void)
 #ifdef ENABLE_AIRCOPY
 	void BK4819_SetupAircopy(void)
 	{
-		BK4819_WriteRegister(BK4819_REG_70, 0x00E0);    // Enable Tone2, tuning gain 48
-		BK4819_WriteRegister(BK4819_REG_72, 0x3065);    // Tone2 baudrate 1200
-		BK4819_WriteRegister(BK4819_REG_58, 0x00C1);    // FSK Enable, FSK 1.2K RX Bandwidth, Preamble 0xAA or 0x55, RX Gain 0, RX Mode
-		                                                // (FSK1.2K, FSK2.4K Rx and NOAA SAME Rx), TX Mode FSK 1.2K and FSK 2.4K Tx
-		BK4819_WriteRegister(BK4819_REG_5C, 0x5665);    // Enable CRC among other things we don't know yet
-		BK4819_WriteRegister(BK4819_REG_5D, 0x4700);    // FSK Data Length 72 Bytes (0xabcd + 2 byte length + 64 byte payload + 2 byte CRC + 0xdcba)
+		static const BK4819_RegPair_t aircopy_table[] =
+		{
+			{BK4819_REG_70, 0x00E0},    // Enable Tone2, tuning gain 48
+			{BK4819_REG_72, 0x3065},    // Tone2 baudrate 1200
+			{BK4819_REG_58, 0x00C1},    // FSK Enable, FSK 1.2K RX Bandwidth, Preamble 0xAA or 0x55, RX Gain 0, RX Mode
+			                            // (FSK1.2K, FSK2.4K Rx and NOAA SAME Rx), TX Mode FSK 1.2K and FSK 2.4K Tx
+			{BK4819_REG_5C, 0x5665},    // Enable CRC among other things we don't know yet
+			{BK4819_REG_5D, 0x4700},    // FSK Data Length 72 Bytes (0xabcd + 2 byte length + 64 byte payload + 2 byte CRC + 0xdcba)
+		};
+
+		BK4819_WriteRegisters(aircopy_table, ARRAY_SIZE(aircopy_table));
 	}
 #endif
 
@@ -1039,10 +1172,15 @@ void BK4819_PrepareTransmit(void)
 
 void BK4819_TxOn_Beep(void)
 {
-	BK4819_WriteRegister(BK4819_REG_37, 0x1D0F);
-	BK4819_WriteRegister(BK4819_REG_52, 0x028F);
-	BK4819_WriteRegister(BK4819_REG_30, 0x0000);
-	BK4819_WriteRegister(BK4819_REG_30, 0xC1FE);
+	static const BK4819_RegPair_t tx_on_table[] =
+	{
+		{BK4819_REG_37, 0x1D0F},
+		{BK4819_REG_52, 0x028F},
+		{BK4819_REG_30, 0x0000},
+		{BK4819_REG_30, 0xC1FE},
+	};
+
+	BK4819_WriteRegisters(tx_on_table, ARRAY_SIZE(tx_on_table));
 }
 
 void BK4819_ExitSubAu(void)
@@ -1168,12 +1306,14 @@ void BK4819_PlayDTMF(char Code)
 		BK4819_WriteRegister(BK4819_REG_72, (((uint32_t)tone2 * 103244) + 5000) / 10000);   // with rounding
 }
 
-void BK4819_PlayDTMFString(const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime)
+bool BK4819_PlayDTMFString(PT_t *pt, const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime)
 {
-	unsigned int i;
+	static unsigned int i;   // survives the yields, one string plays at a time
+
+	PT_BEGIN(pt);
 
 	if (pString == NULL)
-		return;
+		PT_EXIT(pt);
 
 	for (i = 0; pString[i]; i++)
 	{
@@ -1187,14 +1327,18 @@ void BK4819_PlayDTMFString(const char *pString, bool bDelayFirst, uint16_t First
 			Delay = HashCodePersistTime;
 		else
 			Delay = CodePersistTime;
-		SYSTEM_DelayMs(Delay);
+		PT_DELAY_MS(pt, Delay);
 		BK4819_EnterTxMute();
-		SYSTEM_DelayMs(CodeInternalTime);
+		PT_DELAY_MS(pt, CodeInternalTime);
 	}
+
+	PT_END(pt);
 }
 
-void BK4819_TransmitTone(bool bLocalLoopback, uint32_t Frequency)
+bool BK4819_TransmitTone(PT_t *pt, bool bLocalLoopback, uint32_t Frequency)
 {
+	PT_BEGIN(pt);
+
 	BK4819_EnterTxMute();
 
 	// REG_70
@@ -1223,9 +1367,11 @@ void BK4819_TransmitTone(bool bLocalLoopback, uint32_t Frequency)
 
 	BK4819_EnableTXLink();
 
-	SYSTEM_DelayMs(50);
+	PT_DELAY_MS(pt, 50);
 
 	BK4819_ExitTxMute();
+
+	PT_END(pt);
 }
 
 void BK4819_GenTail(uint8_t Tail)
@@ -1343,6 +1489,17 @@ void BK4819_EnableCTCSS(void)
 	BK4819_WriteRegister(BK4819_REG_51, 0x904A); // 1 0 0 1 0 0 0 0 0 1001010
 }
 
+// the BK4819 IRQ output isn't wired to the MCU, a request can only be seen in
+// REG_0C. REG_3F comes from the shadow, so with every source masked (TX, FSK
+// reset, sleep) this costs no SPI at all
+bool BK4819_IsInterruptPending(void)
+{
+	if (BK4819_ReadRegister(BK4819_REG_3F) == 0)
+		return false;
+
+	return (BK4819_ReadRegister(BK4819_REG_0C) & 1u) != 0;
+}
+
 uint16_t BK4819_GetRSSI(void)
 {
 	return BK4819_ReadRegister(BK4819_REG_67) & 0x01FF;
@@ -1580,111 +1737,72 @@ void BK4819_PrepareFSKReceive(void)
 	BK4819_WriteRegister(BK4819_REG_59, 0x3068);
 }
 
-void BK4819_PlayBeep(const uint16_t freq, const int delay)
+// roger beeps as {Hz, ms} pairs ending in a 0 ms step, 0 Hz is a gap
+static const uint16_t RogerMototrbo[]   = { 1540, 80, 1310, 80, 0, 0 };                                         // MOTOTRBO
+static const uint16_t RogerApx6000[]    = { 910, 25, 0, 25, 910, 25, 0, 25, 910, 50, 0, 0 };                    // MOTOROLA APX6000 TPT
+static const uint16_t RogerT40[]        = { 2000, 80, 2200, 80, 2000, 80, 2200, 80, 2000, 80, 2200, 80, 0, 0 }; // MOTOROLA T40
+static const uint16_t RogerTlkrT80[]    = { 1190, 80, 992, 80, 807, 80, 1190, 80, 992, 80, 807, 80,
+                                            1190, 80, 992, 80, 807, 80, 0, 0 };                                 // MOTOROLA TLKRT80
+static const uint16_t RogerCobraAM845[] = { 435, 80, 872, 80, 1742, 80, 0, 0 };                                 // MOTOROLA CobraAM845
+static const uint16_t RogerPoliceItaly[] = { 800, 60, 2200, 60, 885, 60, 1540, 60, 1300, 60, 975, 60,
+                                             1180, 60, 1075, 60, 0, 0 };                                        // PlayRoger Police Italy
+static const uint16_t Roger98[]         = { 2525, 250, 0, 0 };
+static const uint16_t Roger99[]         = { 800, 200, 600, 200, 1000, 200, 0, 0 };   // Frequency and duration can be adjusted
+static const uint16_t RogerDefault[]    = { 500, 80, 700, 80, 0, 0 };
+
+static const uint16_t *BK4819_GetRogerTones(const int roger)
 {
-	BK4819_WriteRegister(BK4819_REG_71, scale_freq(freq));
-	BK4819_ExitTxMute();
-	SYSTEM_DelayMs(delay);
-  	BK4819_EnterTxMute();
+	switch (roger) {
+		case 1:  return RogerMototrbo;
+		case 2:  return RogerApx6000;
+		case 3:  return RogerT40;
+		case 4:  return RogerTlkrT80;
+		case 5:  return RogerCobraAM845;
+		case 6:  return RogerPoliceItaly;
+		case 98: return Roger98;
+		case 99: return Roger99;
+		default: return RogerDefault;
+	}
 }
 
-void BK4819_PlayRogerNormal(const int roger)
+bool BK4819_PlayRogerNormal(PT_t *pt, const int roger)
 {
-	/*#if 0
-		const uint32_t tone1_Hz = 500;
-		const uint32_t tone2_Hz = 700;
-	#else
-		// motorola type
-		const uint32_t tone1_Hz = 1540;
-		const uint32_t tone2_Hz = 1310;
-	#endif*/
+	static const uint16_t *pTone;
 
+	PT_BEGIN(pt);
 
 	BK4819_EnterTxMute();
-  	BK4819_SetAF(BK4819_AF_MUTE);
+	BK4819_SetAF(BK4819_AF_MUTE);
 
 	BK4819_WriteRegister(BK4819_REG_70, BK4819_REG_70_ENABLE_TONE1 | (66u << BK4819_REG_70_SHIFT_TONE1_TUNING_GAIN));
 
 	BK4819_EnableTXLink();
-	SYSTEM_DelayMs(50);
-
-	switch (roger) {
+	PT_DELAY_MS(pt, 50);
 
-		case 1: // MOTOTRBO
-			BK4819_PlayBeep(1540, 80);
-			BK4819_PlayBeep(1310, 80);
-			break;
-		case 2: // MOTOROLA APX6000 TPT
-			BK4819_PlayBeep(910, 25);
-			BK4819_PlayBeep(0, 25);
-			BK4819_PlayBeep(910, 25);
-			BK4819_PlayBeep(0, 25);
-			BK4819_PlayBeep(910, 50);
-			break;
-		case 3: // MOTOROLA T40
-			BK4819_PlayBeep(2000, 80);
-			BK4819_PlayBeep(2200, 80);
-			BK4819_PlayBeep(2000, 80);
-			BK4819_PlayBeep(2200, 80);
-			BK4819_PlayBeep(2000, 80);
-			BK4819_PlayBeep(2200, 80);	  
-			break;	
-		case 4: // MOTOROLA TLKRT80
-			BK4819_PlayBeep(1190, 80);
-			BK4819_PlayBeep(992, 80);
-			BK4819_PlayBeep(807, 80);
-			BK4819_PlayBeep(1190, 80);
-			BK4819_PlayBeep(992, 80);
-			BK4819_PlayBeep(807, 80);
-			BK4819_PlayBeep(1190, 80);
-			BK4819_PlayBeep(992, 80);
-			BK4819_PlayBeep(807, 80);	  
-			break; 
-		case 5: // MOTOROLA CobraAM845
-			BK4819_PlayBeep(435, 80);
-			BK4819_PlayBeep(872, 80);
-			BK4819_PlayBeep(1742, 80); 	
-			break;
-		case 6: // PlayRoger Police Italy
-			BK4819_PlayBeep(800, 60);
-			BK4819_PlayBeep(2200, 60);
-			BK4819_PlayBeep(885, 60);
-			BK4819_PlayBeep(1540, 60);
-			BK4819_PlayBeep(1300, 60);
-			BK4819_PlayBeep(975, 60);
-			BK4819_PlayBeep(1180, 60);
-			BK4819_PlayBeep(1075, 60);
-			break;
-			
-		case 98: // 
-			/*BK4819_PlayBeep(1200, 100);
-			BK4819_PlayBeep(2400, 100);*/
-			BK4819_PlayBeep(2525, 250);
-			break;
-
-		case 99: // 
-			BK4819_PlayBeep(800, 200);  // Frequency and duration can be adjusted
-      		BK4819_PlayBeep(600, 200);
-      		BK4819_PlayBeep(1000, 200);
-			break;
-
-		default: // DEFAULT
-			BK4819_PlayBeep(500, 80);
-			BK4819_PlayBeep(700, 80);
-	}	
+	for (pTone = BK4819_GetRogerTones(roger); pTone[1] > 0; pTone += 2)
+	{
+		BK4819_WriteRegister(BK4819_REG_71, scale_freq(pTone[0]));
+		BK4819_ExitTxMute();
+		PT_DELAY_MS(pt, pTone[1]);
+		BK4819_EnterTxMute();
+	}
 
 	BK4819_WriteRegister(BK4819_REG_70, 0x0000);
 	BK4819_WriteRegister(BK4819_REG_30, 0xC1FE);   // 1 1 0000 0 1 1111 1 1 1 0
+
+	PT_END(pt);
 }
-void BK4819_PlayRoger(void)
+
+bool BK4819_PlayRoger(PT_t *pt)
 {
 
 	/*if (gEeprom.ROGER == ROGER_MODE_MDC)
 		BK4819_PlayRogerMDC();
 	else*/
-	if (gEeprom.ROGER != ROGER_MODE_OFF) {
-		BK4819_PlayRogerNormal(gEeprom.ROGER - 1);
-	}
+	if (gEeprom.ROGER == ROGER_MODE_OFF)
+		return false;
+
+	return BK4819_PlayRogerNormal(pt, gEeprom.ROGER - 1);
 }
 
 
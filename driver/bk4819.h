@@ -18,9 +18,11 @@
 #define DRIVER_BK4819_h
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "driver/bk4819-regs.h"
+#include "helper/pt.h"
 
 enum BK4819_AF_Type_t
 {
@@ -62,12 +64,20 @@ enum BK4819_CssScanResult_t
 
 typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 
+// one entry of a register programming sequence, see BK4819_WriteRegisters()
+typedef struct
+{
+	uint8_t  Register;
+	uint16_t Value;
+} BK4819_RegPair_t;
+
 // radio is asleep, not listening
 extern bool gRxIdleMode;
 
 void     BK4819_Init(void);
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register);
 void     BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data);
+void     BK4819_WriteRegisters(const BK4819_RegPair_t *pList, size_t Count);
 void     BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
@@ -105,7 +115,7 @@ void     BK4819_DisableVox(void);
 void     BK4819_DisableDTMF(void);
 void     BK4819_EnableDTMF(void);
 void     BK4819_PlayTone(uint16_t Frequency, bool bTuningGainSwitch);
-void     BK4819_PlaySingleTone(const unsigned int tone_Hz, const unsigned int delay, const unsigned int level, const bool play_speaker);
+bool     BK4819_PlaySingleTone(PT_t *pt, const unsigned int tone_Hz, const unsigned int delay, const unsigned int level, const bool play_speaker);
 void     BK4819_EnterTxMute(void);
 void     BK4819_ExitTxMute(void);
 void     BK4819_Sleep(void);
@@ -127,14 +137,15 @@ void     BK4819_ExitDTMF_TX(bool bKeep);
 void     BK4819_EnableTXLink(void);
 
 void     BK4819_PlayDTMF(char Code);
-void     BK4819_PlayDTMFString(const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime);
+bool     BK4819_PlayDTMFString(PT_t *pt, const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime);
 
-void     BK4819_TransmitTone(bool bLocalLoopback, uint32_t Frequency);
+bool     BK4819_TransmitTone(PT_t *pt, bool bLocalLoopback, uint32_t Frequency);
 
 void     BK4819_GenTail(uint8_t Tail);
 void     BK4819_EnableCDCSS(void);
 void     BK4819_EnableCTCSS(void);
 
+bool     BK4819_IsInterruptPending(void);
 uint16_t BK4819_GetRSSI(void);
 uint8_t  BK4819_GetGlitchIndicator(void);
 uint8_t  BK4819_GetExNoiceIndicator(void);
@@ -160,8 +171,8 @@ uint8_t  BK4819_GetCTCType(void);
 void     BK4819_SendFSKData(uint16_t *pData);
 void     BK4819_PrepareFSKReceive(void);
 	    
-void     BK4819_PlayRogerNormal(const int roger);
-void     BK4819_PlayRoger();
+bool     BK4819_PlayRogerNormal(PT_t *pt, const int roger);
+bool     BK4819_PlayRoger(PT_t *pt);
 	    
 void     BK4819_Enable_AfDac_DiscMode_TxDsp(void);
 
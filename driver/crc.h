@@ -19,8 +19,18 @@
 
 #include <stdint.h>
 
+extern const uint16_t gCrc16Table[256];
+
 void CRC_Init(void);
 uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size);
 
+// software CRC for streaming, start with Crc = 0 and feed the bytes as they come
+uint16_t CRC_Update(uint16_t Crc, const void *pBuffer, uint16_t Size);
+
+static inline uint16_t CRC_UpdateByte(uint16_t Crc, uint8_t Byte)
+{
+	return (uint16_t)(Crc << 8) ^ gCrc16Table[(Crc >> 8) ^ Byte];
+}
+
 #endif
 
@@ -14,14 +14,37 @@
  *     limitations under the License.
  */
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
 #include "driver/eeprom.h"
 #include "driver/i2c.h"
-#include "driver/system.h"
 
-void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+// 24C64: 8K bytes in 32 byte write pages
+#define EEPROM_SIZE        0x2000U
+#define EEPROM_PAGE_SIZE   32U
+
+// one poll is a START, 9 clocks and a STOP, roughly 25us
+#define EEPROM_POLL_LIMIT  800U
+
+#ifdef ENABLE_EEPROM_CACHE
+	// cache over the regions the UI, scanner and settings code keep reading
+	// (see gEepromRegions), dirty lines are burnt in by EEPROM_Flush()
+	#define EEPROM_LINE_SIZE   64U
+	#define EEPROM_LINE_COUNT  8U
+
+	typedef struct {
+		uint8_t Data[EEPROM_LINE_SIZE];
+		uint8_t Tag;     // (Address / EEPROM_LINE_SIZE) + 1, 0 = slot unused
+		uint8_t Age;     // LRU rank among the used slots, 0 = most recent
+	} EEPROM_CacheLine_t;
+
+	static EEPROM_CacheLine_t gEepromCache[EEPROM_LINE_COUNT];
+	static uint8_t            gEepromCacheDirty;   // one bit per slot
+#endif
+
+static void EEPROM_ReadChip(uint16_t Address, void *pBuffer, uint8_t Size)
 {
 	I2C_Start();
 
@@ -39,25 +62,267 @@ void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
 	I2C_Stop();
 }
 
-void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer)
+// the EEPROM does not ACK its address while it is burning a page in,
+// poll it until it does (or give up after well over the 5ms write time)
+static void EEPROM_WaitReady(void)
 {
-	if (pBuffer == NULL || Address >= 0x2000)
-		return;
+	for (unsigned int i = 0; i < EEPROM_POLL_LIMIT; i++) {
+		I2C_Start();
+		const int ret = I2C_Write(0xA0);
+		I2C_Stop();
+		if (ret == 0)
+			return;
+	}
+}
 
+static void EEPROM_WritePage(uint16_t Address, const uint8_t *pData, uint8_t Size)
+{
+	uint8_t buffer[EEPROM_PAGE_SIZE];
 
-	uint8_t buffer[8];
-	EEPROM_ReadBuffer(Address, buffer, 8);
-	if (memcmp(pBuffer, buffer, 8) == 0) {
+	// skip the write cycle when the data is already there
+	EEPROM_ReadChip(Address, buffer, Size);
+	if (memcmp(pData, buffer, Size) == 0)
 		return;
-	}
 
 	I2C_Start();
 	I2C_Write(0xA0);
 	I2C_Write((Address >> 8) & 0xFF);
 	I2C_Write((Address >> 0) & 0xFF);
-	I2C_WriteBuffer(pBuffer, 8);
+	I2C_WriteBuffer(pData, Size);
 	I2C_Stop();
 
-	// give the EEPROM time to burn the data in (apparently takes 5ms)
-	SYSTEM_DelayMs(8);
+	EEPROM_WaitReady();
+}
+
+static void EEPROM_WriteChip(uint16_t Address, const uint8_t *pData, uint16_t Size)
+{
+	while (Size > 0) {
+		// a write must not wrap around the end of its page
+		uint16_t Chunk = EEPROM_PAGE_SIZE - (Address % EEPROM_PAGE_SIZE);
+		if (Chunk > Size)
+			Chunk = Size;
+
+		EEPROM_WritePage(Address, pData, Chunk);
+
+		Address += Chunk;
+		pData   += Chunk;
+		Size    -= Chunk;
+	}
+}
+
+#ifdef ENABLE_EEPROM_CACHE
+
+typedef struct {
+	uint16_t Start;
+	uint16_t End;
+	bool     bWriteThrough;   // read mostly, writes go to the chip at once
+} EEPROM_Region_t;
+
+// sorted, a line may straddle a region edge, only the part inside is used
+static const EEPROM_Region_t gEepromRegions[] = {
+	{ 0x0000, 0x0D60, false },   // channel and VFO records
+	{ 0x0F50, 0x1C00, false },   // channel names
+	{ 0x1E00, 0x2000, true  },   // calibration and build options
+};
+
+// the region holding Address or NULL, *pChunk is cut back so it neither
+// runs out of the region nor into the next one
+static const EEPROM_Region_t *EEPROM_Region(uint16_t Address, uint16_t *pChunk)
+{
+	for (unsigned int i = 0; i < sizeof(gEepromRegions) / sizeof(gEepromRegions[0]); i++) {
+		const EEPROM_Region_t *pRegion = &gEepromRegions[i];
+
+		if (Address < pRegion->Start) {
+			if (*pChunk > pRegion->Start - Address)
+				*pChunk = pRegion->Start - Address;
+			return NULL;
+		}
+		if (Address < pRegion->End) {
+			if (*pChunk > pRegion->End - Address)
+				*pChunk = pRegion->End - Address;
+			return pRegion;
+		}
+	}
+
+	return NULL;
+}
+
+// makes the slot the most recent one, the slots that were more recent
+// than it age by one, so the ranks stay 0..EEPROM_LINE_COUNT-1 for good
+static void EEPROM_CacheTouch(unsigned int Slot)
+{
+	const uint8_t Age = gEepromCache[Slot].Age;
+
+	for (unsigned int i = 0; i < EEPROM_LINE_COUNT; i++)
+		if (gEepromCache[i].Tag != 0 && gEepromCache[i].Age < Age)
+			gEepromCache[i].Age++;
+
+	gEepromCache[Slot].Age = 0;
+}
+
+static void EEPROM_CacheWriteBack(unsigned int Slot)
+{
+	const EEPROM_CacheLine_t *pLine = &gEepromCache[Slot];
+
+	if (gEepromCacheDirty & (1u << Slot)) {
+		const uint16_t Line    = (pLine->Tag - 1) * EEPROM_LINE_SIZE;
+		uint16_t       Address = Line;
+
+		// the bytes outside the regions were written to the chip directly
+		while (Address < Line + EEPROM_LINE_SIZE) {
+			uint16_t Chunk = Line + EEPROM_LINE_SIZE - Address;
+			if (EEPROM_Region(Address, &Chunk) != NULL)
+				EEPROM_WriteChip(Address, pLine->Data + (Address - Line), Chunk);
+			Address += Chunk;
+		}
+
+		gEepromCacheDirty &= ~(1u << Slot);
+	}
+}
+
+// returns the cache slot holding the line, loading it (and writing back
+// the least recently used slot if need be) on a miss
+static unsigned int EEPROM_CacheFetch(uint16_t Address)
+{
+	const uint8_t Tag    = (Address / EEPROM_LINE_SIZE) + 1;
+	unsigned int  Victim = 0;
+
+	for (unsigned int i = 0; i < EEPROM_LINE_COUNT; i++) {
+		EEPROM_CacheLine_t *pLine = &gEepromCache[i];
+		if (pLine->Tag == Tag) {
+			EEPROM_CacheTouch(i);
+			return i;
+		}
+		if (gEepromCache[Victim].Tag != 0 && (pLine->Tag == 0 || pLine->Age > gEepromCache[Victim].Age))
+			Victim = i;
+	}
+
+	EEPROM_CacheLine_t *pLine = &gEepromCache[Victim];
+
+	if (pLine->Tag == 0)
+		pLine->Age = EEPROM_LINE_COUNT;   // older than all, every used slot ages
+
+	EEPROM_CacheWriteBack(Victim);
+
+	EEPROM_ReadChip((Tag - 1) * EEPROM_LINE_SIZE, pLine->Data, EEPROM_LINE_SIZE);
+	pLine->Tag = Tag;
+	EEPROM_CacheTouch(Victim);
+
+	return Victim;
+}
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+{
+	uint8_t *pData = (uint8_t *)pBuffer;
+
+	if (Address >= EEPROM_SIZE || Size > EEPROM_SIZE - Address) {
+		EEPROM_ReadChip(Address, pBuffer, Size);
+		return;
+	}
+
+	while (Size > 0) {
+		const uint8_t Offset = Address % EEPROM_LINE_SIZE;
+		uint16_t      Chunk  = EEPROM_LINE_SIZE - Offset;
+		if (Chunk > Size)
+			Chunk = Size;
+
+		if (EEPROM_Region(Address, &Chunk) != NULL)
+			memcpy(pData, gEepromCache[EEPROM_CacheFetch(Address)].Data + Offset, Chunk);
+		else
+			EEPROM_ReadChip(Address, pData, Chunk);
+
+		Address += Chunk;
+		pData   += Chunk;
+		Size    -= Chunk;
+	}
+}
+
+void EEPROM_WriteRange(uint16_t Address, const void *pBuffer, uint16_t Size)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+
+	if (pBuffer == NULL || Address >= EEPROM_SIZE || Size > EEPROM_SIZE - Address)
+		return;
+
+	while (Size > 0) {
+		const uint8_t Offset = Address % EEPROM_LINE_SIZE;
+		uint16_t      Chunk  = EEPROM_LINE_SIZE - Offset;
+		if (Chunk > Size)
+			Chunk = Size;
+
+		const EEPROM_Region_t *pRegion = EEPROM_Region(Address, &Chunk);
+
+		if (pRegion != NULL) {
+			const unsigned int  Slot  = EEPROM_CacheFetch(Address);
+			uint8_t            *pLine = gEepromCache[Slot].Data + Offset;
+			if (memcmp(pLine, pData, Chunk) != 0) {
+				memcpy(pLine, pData, Chunk);
+				if (pRegion->bWriteThrough)
+					EEPROM_WriteChip(Address, pData, Chunk);
+				else
+					gEepromCacheDirty |= 1u << Slot;
+			}
+		} else {
+			EEPROM_WriteChip(Address, pData, Chunk);
+		}
+
+		Address += Chunk;
+		pData   += Chunk;
+		Size    -= Chunk;
+	}
+}
+
+void EEPROM_WriteThrough(uint16_t Address, const void *pBuffer, uint16_t Size)
+{
+	EEPROM_WriteRange(Address, pBuffer, Size);
+
+	if (Size == 0)
+		return;
+
+	// the lines are still cached, EEPROM_WriteRange() just fetched them
+	for (unsigned int i = 0; i < EEPROM_LINE_COUNT; i++) {
+		const uint16_t Line = (gEepromCache[i].Tag - 1) * EEPROM_LINE_SIZE;
+		if (gEepromCache[i].Tag != 0 && Line + EEPROM_LINE_SIZE > Address && Line < Address + Size)
+			EEPROM_CacheWriteBack(i);
+	}
+}
+
+bool EEPROM_FlushLine(void)
+{
+	for (unsigned int i = 0; i < EEPROM_LINE_COUNT; i++) {
+		if (gEepromCacheDirty & (1u << i)) {
+			EEPROM_CacheWriteBack(i);
+			break;
+		}
+	}
+
+	return gEepromCacheDirty != 0;
+}
+
+void EEPROM_Flush(void)
+{
+	while (EEPROM_FlushLine())
+		;
+}
+
+#else
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+{
+	EEPROM_ReadChip(Address, pBuffer, Size);
+}
+
+void EEPROM_WriteRange(uint16_t Address, const void *pBuffer, uint16_t Size)
+{
+	if (pBuffer == NULL || Address >= EEPROM_SIZE || Size > EEPROM_SIZE - Address)
+		return;
+
+	EEPROM_WriteChip(Address, pBuffer, Size);
+}
+
+#endif
+
+void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer)
+{
+	EEPROM_WriteRange(Address, pBuffer, 8);
 }
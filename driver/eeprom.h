@@ -17,10 +17,27 @@
 #ifndef DRIVER_EEPROM_H
 #define DRIVER_EEPROM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size);
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer);
+void EEPROM_WriteRange(uint16_t Address, const void *pBuffer, uint16_t Size);
+
+#ifdef ENABLE_EEPROM_CACHE
+	// writes the range and burns it in right away, for records the user saved
+	void EEPROM_WriteThrough(uint16_t Address, const void *pBuffer, uint16_t Size);
+	// writes back one dirty line, true while more are left
+	bool EEPROM_FlushLine(void);
+	void EEPROM_Flush(void);
+#else
+	static inline void EEPROM_WriteThrough(uint16_t Address, const void *pBuffer, uint16_t Size)
+	{
+		EEPROM_WriteRange(Address, pBuffer, Size);
+	}
+	static inline bool EEPROM_FlushLine(void) { return false; }
+	static inline void EEPROM_Flush(void) {}
+#endif
 
 #endif
 
@@ -20,28 +20,34 @@
 #include "driver/i2c.h"
 #include "driver/systick.h"
 
+// bus timing in ns for the 24C64 EEPROM in 400kHz fast mode. tHIGH is the
+// 600ns minimum, the low phase is stretched past its 1300ns minimum so a
+// bit takes at least 2.5us
+#define I2C_T_HIGH_NS  600    // SCL high, also START/STOP setup and hold
+#define I2C_T_LOW_NS   1900   // SCL low, also bus free time after STOP
+
 void I2C_Start(void)
 {
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 }
 
 void I2C_Stop(void)
 {
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_LOW_NS);
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_LOW_NS);
 }
 
 uint8_t I2C_Read(bool bFinal)
@@ -55,33 +61,29 @@ uint8_t I2C_Read(bool bFinal)
 	Data = 0;
 	for (i = 0; i < 8; i++) {
 		GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(I2C_T_LOW_NS);
 		GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-		SYSTICK_DelayUs(1);
 		Data <<= 1;
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(I2C_T_HIGH_NS);
 		if (GPIO_CheckBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA)) {
 			Data |= 1U;
 		}
 		GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-		SYSTICK_DelayUs(1);
 	}
 
 	PORTCON_PORTA_IE &= ~PORTCON_PORTA_IE_A11_MASK;
 	PORTCON_PORTA_OD |= PORTCON_PORTA_OD_A11_BITS_ENABLE;
 	GPIOA->DIR |= GPIO_DIR_11_BITS_OUTPUT;
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
 	if (bFinal) {
 		GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
 	} else {
 		GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
 	}
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_LOW_NS);
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
 
 	return Data;
 }
@@ -92,7 +94,6 @@ int I2C_Write(uint8_t Data)
 	int ret = -1;
 
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
 	for (i = 0; i < 8; i++) {
 		if ((Data & 0x80) == 0) {
 			GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
@@ -100,20 +101,19 @@ int I2C_Write(uint8_t Data)
 			GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
 		}
 		Data <<= 1;
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(I2C_T_LOW_NS);
 		GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-		SYSTICK_DelayUs(1);
+		SYSTICK_DelayNs(I2C_T_HIGH_NS);
 		GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-		SYSTICK_DelayUs(1);
 	}
 
 	PORTCON_PORTA_IE |= PORTCON_PORTA_IE_A11_BITS_ENABLE;
 	PORTCON_PORTA_OD &= ~PORTCON_PORTA_OD_A11_MASK;
 	GPIOA->DIR &= ~GPIO_DIR_11_MASK;
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_LOW_NS);
 	GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
+	SYSTICK_DelayNs(I2C_T_HIGH_NS);
 
 	for (i = 0; i < 255; i++) {
 		if (GPIO_CheckBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA) == 0) {
@@ -123,7 +123,6 @@ int I2C_Write(uint8_t Data)
 	}
 
 	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
-	SYSTICK_DelayUs(1);
 	PORTCON_PORTA_IE &= ~PORTCON_PORTA_IE_A11_MASK;
 	PORTCON_PORTA_OD |= PORTCON_PORTA_OD_A11_BITS_ENABLE;
 	GPIOA->DIR |= GPIO_DIR_11_BITS_OUTPUT;
@@ -138,11 +137,9 @@ int I2C_ReadBuffer(void *pBuffer, uint8_t Size)
 	uint8_t i;
 
 	for (i = 0; i < Size - 1; i++) {
-		SYSTICK_DelayUs(1);
 		pData[i] = I2C_Read(false);
 	}
 
-	SYSTICK_DelayUs(1);
 	pData[i] = I2C_Read(true);
 
 	return Size;
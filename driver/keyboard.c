@@ -29,9 +29,7 @@
 	uint8_t gPttCounter = 0;
 #endif
 
-KEY_Code_t gKeyReading0     = KEY_INVALID;
 KEY_Code_t gKeyReading1     = KEY_INVALID;
-uint16_t   gDebounceCounter = 0;
 bool       gWasFKeyPressed  = false;
 
 static const struct {
@@ -99,6 +97,82 @@ static const struct {
 	}
 };
 
+#define KEYBOARD_COLUMNS (1u << GPIOA_PIN_KEYBOARD_4 | 1u << GPIOA_PIN_KEYBOARD_5 | 1u << GPIOA_PIN_KEYBOARD_6 | 1u << GPIOA_PIN_KEYBOARD_7)
+#define KEYBOARD_INPUTS  (1u << GPIOA_PIN_KEYBOARD_0 | 1u << GPIOA_PIN_KEYBOARD_1 | 1u << GPIOA_PIN_KEYBOARD_2 | 1u << GPIOA_PIN_KEYBOARD_3)
+#define KEYBOARD_NOISE   0xFFFFu
+
+// last key the matrix scan found, kept through a noisy read
+static KEY_Code_t gKeyScanned = KEY_INVALID;
+
+// debounce and hold state of KEYBOARD_Service
+static KEY_Code_t gKeyRaw      = KEY_INVALID;
+static KEY_Code_t gKeyDown     = KEY_INVALID;
+static uint32_t   gKeyStamp;
+static uint32_t   gKeyRepeatStamp;
+static bool       gKeyStable;
+static bool       gKeyHeld;
+
+static KEY_Event_t gKeyEvents[8];
+static uint8_t     gKeyEventHead;
+static uint8_t     gKeyEventTail;
+
+// Read all 4 GPIO pins at once .. with de-noise, max of 8 sample loops
+static uint16_t KEYBOARD_ReadInputs(void)
+{
+	uint16_t reg;
+	unsigned int i;
+	unsigned int k;
+
+	for (i = 0, k = 0, reg = 0; i < 3 && k < 8; i++, k++) {
+		SYSTICK_DelayUs(1);
+		uint16_t reg2 = GPIOA->DATA;
+		i *= reg == reg2;
+		reg = reg2;
+	}
+
+	return (i < 3) ? KEYBOARD_NOISE : (reg & KEYBOARD_INPUTS);
+}
+
+static KEY_Code_t KEYBOARD_Scan(void)
+{
+	for (unsigned int j = 0; j < ARRAY_SIZE(keyboard); j++)
+	{
+		uint16_t reg;
+
+		// Set all high
+		GPIOA->DATA |= KEYBOARD_COLUMNS;
+
+		// Clear the pin we are selecting
+		GPIOA->DATA &= keyboard[j].set_to_zero_mask;
+
+		reg = KEYBOARD_ReadInputs();
+		if (reg == KEYBOARD_NOISE)
+			break;	// noise is too bad
+
+		for (unsigned int i = 0; i < ARRAY_SIZE(keyboard[j].pins); i++)
+		{
+			const uint16_t mask = 1u << keyboard[j].pins[i].pin;
+			if (!(reg & mask))
+				return keyboard[j].pins[i].key;
+		}
+	}
+
+	return KEY_INVALID;
+}
+
+static void KEYBOARD_PushEvent(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
+{
+	const uint8_t Next = (gKeyEventHead + 1) % ARRAY_SIZE(gKeyEvents);
+
+	if (Next == gKeyEventTail)
+		return;     // nobody is reading, drop it
+
+	gKeyEvents[gKeyEventHead].Key         = Key;
+	gKeyEvents[gKeyEventHead].bKeyPressed = bKeyPressed;
+	gKeyEvents[gKeyEventHead].bKeyHeld    = bKeyHeld;
+	gKeyEventHead = Next;
+}
+
 KEY_Code_t KEYBOARD_Poll(void)
 {
 	#ifdef ENABLE_SCREEN_DUMP
@@ -122,60 +196,100 @@ KEY_Code_t KEYBOARD_Poll(void)
 		}
 	#endif
 	
-	KEY_Code_t Key = KEY_INVALID;
-
 //	if (!GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT))
 //		return KEY_PTT;
 
 	// *****************
 
-	for (unsigned int j = 0; j < ARRAY_SIZE(keyboard); j++)
-	{
-		uint16_t reg;
-		unsigned int i;
-		unsigned int k;
+	// pull every column down at once, any pressed key shows up on the inputs
+	GPIOA->DATA &= ~KEYBOARD_COLUMNS;
 
-		// Set all high
-		GPIOA->DATA |=  1u << GPIOA_PIN_KEYBOARD_4 |
-						1u << GPIOA_PIN_KEYBOARD_5 |
-						1u << GPIOA_PIN_KEYBOARD_6 |
-						1u << GPIOA_PIN_KEYBOARD_7;
+	const uint16_t Inputs = KEYBOARD_ReadInputs();
 
-		// Clear the pin we are selecting
-		GPIOA->DATA &= keyboard[j].set_to_zero_mask;
+	if (Inputs == KEYBOARD_INPUTS)
+		gKeyScanned = KEY_INVALID;      // nothing pressed, one read is all it takes
+	else if (Inputs != KEYBOARD_NOISE)
+		gKeyScanned = KEYBOARD_Scan();  // every tick, keys on the same input look alike from here
+
+	// Create I2C stop condition since we might have toggled I2C pins
+	// This leaves GPIOA_PIN_KEYBOARD_4 and GPIOA_PIN_KEYBOARD_5 high
+	I2C_Stop();
+
+	// Reset VOICE pins
+	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_KEYBOARD_6);
+	GPIO_SetBit(  &GPIOA->DATA, GPIOA_PIN_KEYBOARD_7);
 
-		// Read all 4 GPIO pins at once .. with de-noise, max of 8 sample loops
-		for (i = 0, k = 0, reg = 0; i < 3 && k < 8; i++, k++) {
-			SYSTICK_DelayUs(1);
-			uint16_t reg2 = GPIOA->DATA;
-			i *= reg == reg2;
-			reg = reg2;
+	return gKeyScanned;
+}
+
+// called every 10ms, turns key transitions into press, hold and release events
+KEY_Code_t KEYBOARD_Service(uint32_t Now_10ms)
+{
+	const KEY_Code_t Key = KEYBOARD_Poll();
+
+	if (Key != gKeyRaw)
+	{
+		if (gKeyRaw != KEY_INVALID && Key != KEY_INVALID && gKeyDown != KEY_INVALID)
+		{	// key pressed without releasing previous key
+			KEYBOARD_PushEvent(gKeyDown, false, gKeyHeld);
+			gKeyDown = KEY_INVALID;
 		}
 
-		if (i < 3)
-			break;	// noise is too bad
+		gKeyRaw    = Key;
+		gKeyStamp  = Now_10ms;
+		gKeyStable = false;
+		return Key;
+	}
 
-		for (unsigned int i = 0; i < ARRAY_SIZE(keyboard[j].pins); i++)
+	const uint32_t Elapsed = Now_10ms - gKeyStamp;
+
+	if (!gKeyStable)
+	{
+		if (Elapsed < key_debounce_10ms)
+			return Key;
+
+		gKeyStable = true;
+
+		if (Key == KEY_INVALID)
 		{
-			const uint16_t mask = 1u << keyboard[j].pins[i].pin;
-			if (!(reg & mask))
-			{
-				Key = keyboard[j].pins[i].key;
-				break;
-			}
+			if (gKeyDown != KEY_INVALID)
+				KEYBOARD_PushEvent(gKeyDown, false, gKeyHeld);
 		}
+		else
+			KEYBOARD_PushEvent(Key, true, false);
 
-		if (Key != KEY_INVALID)
-			break;
+		gKeyDown = Key;
+		gKeyHeld = false;
+		return Key;
 	}
 
-	// Create I2C stop condition since we might have toggled I2C pins
-	// This leaves GPIOA_PIN_KEYBOARD_4 and GPIOA_PIN_KEYBOARD_5 high
-	I2C_Stop();
+	if (Key == KEY_INVALID || Key == KEY_PTT)
+		return Key;
 
-	// Reset VOICE pins
-	GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_KEYBOARD_6);
-	GPIO_SetBit(  &GPIOA->DATA, GPIOA_PIN_KEYBOARD_7);
+	if (!gKeyHeld)
+	{
+		if (Elapsed >= key_repeat_delay_10ms)
+		{	// initial key repeat with longer delay
+			gKeyHeld        = true;
+			gKeyRepeatStamp = Now_10ms;
+			KEYBOARD_PushEvent(Key, true, true);
+		}
+	}
+	else if ((Key == KEY_UP || Key == KEY_DOWN) && (Now_10ms - gKeyRepeatStamp) >= key_repeat_10ms)
+	{	// fast key repeats for up/down buttons
+		gKeyRepeatStamp = Now_10ms;
+		KEYBOARD_PushEvent(Key, true, true);
+	}
 
 	return Key;
 }
+
+bool KEYBOARD_GetEvent(KEY_Event_t *pEvent)
+{
+	if (gKeyEventTail == gKeyEventHead)
+		return false;
+
+	*pEvent = gKeyEvents[gKeyEventTail];
+	gKeyEventTail = (gKeyEventTail + 1) % ARRAY_SIZE(gKeyEvents);
+	return true;
+}
@@ -45,6 +45,12 @@ enum KEY_Code_e {
 };
 typedef enum KEY_Code_e KEY_Code_t;
 
+typedef struct {
+	KEY_Code_t Key;
+	bool       bKeyPressed;
+	bool       bKeyHeld;
+} KEY_Event_t;
+
 #ifdef ENABLE_SCREEN_DUMP
 	extern KEY_Code_t gSimulateKey;
 	extern KEY_Code_t gSimulateHold;
@@ -52,12 +58,12 @@ typedef enum KEY_Code_e KEY_Code_t;
 	extern uint8_t gPttCounter;
 #endif
 
-extern KEY_Code_t gKeyReading0;
 extern KEY_Code_t gKeyReading1;
-extern uint16_t   gDebounceCounter;
 extern bool       gWasFKeyPressed;
 
 KEY_Code_t KEYBOARD_Poll(void);
+KEY_Code_t KEYBOARD_Service(uint32_t Now_10ms);
+bool       KEYBOARD_GetEvent(KEY_Event_t *pEvent);
 
 #endif
 
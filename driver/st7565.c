@@ -17,12 +17,18 @@
 #include <stdint.h>
 #include <stdio.h>     // NULL
 
+#ifdef ENABLE_LCD_DMA
+	#include "ARMCM0.h"
+	#include "bsp/dp32g030/dma.h"
+	#include "bsp/dp32g030/irq.h"
+#endif
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/spi.h"
 #include "driver/gpio.h"
 #include "driver/spi.h"
 #include "driver/st7565.h"
 #include "driver/system.h"
+#include "driver/systick.h"
 #include "misc.h"
 
 #ifdef ENABLE_CONTRAST
@@ -32,6 +38,26 @@
 uint8_t gStatusLine[LCD_WIDTH];
 uint8_t gFrameBuffer[FRAME_LINES][LCD_WIDTH];
 
+// ST7565_Flush() only sends the column spans that changed since they were
+// last sent, a hash per span tells it what the LCD is showing
+#define ST7565_SPAN_WIDTH  16U
+#define ST7565_SPANS       (LCD_WIDTH / ST7565_SPAN_WIDTH)
+
+static uint32_t gSpanHash[FRAME_LINES][ST7565_SPANS];
+static uint8_t  gLinesInSync;   // one bit per frame line, hashes are valid
+
+uint16_t gST7565_FlushSavedBytes;
+
+#ifdef ENABLE_LCD_DMA
+	// DMA channel 0 is the UART RX ring, the LCD gets channel 1
+	// SPI0 TX request line on the DMA handshake mux
+	#define ST7565_DMA_HSREQ  DMA_CH_MOD_MD_SEL_BITS_HSREQ_MS4
+	// a full frame goes out in a couple of ms, past this the DMA has stalled
+	#define ST7565_BLIT_TIMEOUT_US  20000U
+
+	static volatile uint8_t gBlitLine = FRAME_LINES;   // page being sent, FRAME_LINES = idle
+#endif
+
 static void DrawLine(uint8_t column, uint8_t line, const uint8_t * lineBuffer, unsigned size_defVal)
 {	
 	ST7565_SelectColumnAndLine(column + 4, line);
@@ -43,8 +69,128 @@ static void DrawLine(uint8_t column, uint8_t line, const uint8_t * lineBuffer, u
 	SPI_WaitForUndocumentedTxFifoStatusBit();
 }
 
+static uint32_t HashSpan(const uint8_t *pData)
+{	// FNV-1a
+	uint32_t hash = 2166136261U;
+	for (unsigned i = 0; i < ST7565_SPAN_WIDTH; i++)
+		hash = (hash ^ pData[i]) * 16777619U;
+	return hash;
+}
+
+static void SyncLine(unsigned line)
+{
+	for (unsigned span = 0; span < ST7565_SPANS; span++)
+		gSpanHash[line][span] = HashSpan(&gFrameBuffer[line][span * ST7565_SPAN_WIDTH]);
+	gLinesInSync |= 1u << line;
+}
+
+#ifdef ENABLE_LCD_DMA
+static void ST7565_StartLineDMA(unsigned line)
+{
+	ST7565_SelectColumnAndLine(4, line + 1);
+	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+
+	DMA_CH1->MSADDR = (uint32_t)(uintptr_t)gFrameBuffer[line];
+	DMA_CH1->MDADDR = (uint32_t)(uintptr_t)&SPI0->WDR;
+	DMA_CH1->MOD = 0
+		// Source
+		| DMA_CH_MOD_MS_ADDMOD_BITS_INCREMENT
+		| DMA_CH_MOD_MS_SIZE_BITS_8BIT
+		| DMA_CH_MOD_MS_SEL_BITS_SRAM
+		// Destination
+		| DMA_CH_MOD_MD_ADDMOD_BITS_NONE
+		| DMA_CH_MOD_MD_SIZE_BITS_8BIT
+		| ST7565_DMA_HSREQ
+		;
+	DMA_CH1->CTR = 0
+		| DMA_CH_CTR_CH_EN_BITS_ENABLE
+		| (((LCD_WIDTH - 1) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+		| DMA_CH_CTR_LOOP_BITS_DISABLE
+		| DMA_CH_CTR_PRI_BITS_LOW
+		;
+}
+
+static void ST7565_EndBlitDMA(void)
+{
+	DMA_INTEN &= ~DMA_INTEN_CH1_TC_INTEN_MASK;
+	DMA_CH1->CTR = DMA_CH_CTR_CH_EN_BITS_DISABLE;
+	SPI0->CR &= ~SPI_CR_TXDMAEN_MASK;
+	SPI_ToggleMasterMode(&SPI0->CR, true);
+	gBlitLine = FRAME_LINES;
+}
+
+void HandlerDMA(void);
+
+void HandlerDMA(void)
+{
+	if ((DMA_INTST & DMA_INTST_CH1_TC_INTST_MASK) == DMA_INTST_CH1_TC_INTST_BITS_NOT_SET)
+		return;
+
+	DMA_INTST = DMA_INTST_CH1_TC_INTST_BITS_SET;
+	DMA_CH1->CTR = DMA_CH_CTR_CH_EN_BITS_DISABLE;
+
+	// the last bytes of the page are still in the FIFO, A0 must not
+	// drop for the next page commands until they are out
+	SPI_WaitForUndocumentedTxFifoStatusBit();
+
+	if (gBlitLine + 1 < FRAME_LINES) {
+		gBlitLine++;
+		ST7565_StartLineDMA(gBlitLine);
+	} else {
+		ST7565_EndBlitDMA();
+	}
+}
+
+void ST7565_BlitFullScreenAsync(void)
+{
+	ST7565_WaitBlit();
+
+	SPI_ToggleMasterMode(&SPI0->CR, false);
+	ST7565_WriteByte(0x40);
+	SPI0->CR |= SPI_CR_TXDMAEN_MASK;
+
+	DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
+	DMA_INTST = DMA_INTST_CH1_TC_INTST_BITS_SET;
+	DMA_INTEN |= DMA_INTEN_CH1_TC_INTEN_BITS_ENABLE;
+
+	for (unsigned line = 0; line < FRAME_LINES; line++)
+		SyncLine(line);
+
+	gBlitLine = 0;
+	ST7565_StartLineDMA(0);
+}
+
+bool ST7565_IsBlitBusy(void)
+{
+	return gBlitLine < FRAME_LINES;
+}
+
+void ST7565_WaitBlit(void)
+{
+	uint32_t Count   = SYSTICK_GetCount();
+	uint32_t Elapsed = 0;
+
+	while (gBlitLine < FRAME_LINES) {
+		Elapsed += SYSTICK_CyclesSince(&Count);
+		if (Elapsed > ST7565_BLIT_TIMEOUT_US * SYSTICK_CORE_CLOCK_MHZ) {
+			// the DMA stalled, push the rest of the frame out by hand
+			DMA_INTEN &= ~DMA_INTEN_CH1_TC_INTEN_MASK;
+			DMA_CH1->CTR = DMA_CH_CTR_CH_EN_BITS_DISABLE;
+			SPI0->CR &= ~SPI_CR_TXDMAEN_MASK;
+			SPI_WaitForUndocumentedTxFifoStatusBit();
+			for (unsigned line = gBlitLine; line < FRAME_LINES; line++)
+				DrawLine(0, line + 1, gFrameBuffer[line], LCD_WIDTH);
+			ST7565_EndBlitDMA();
+		}
+	}
+}
+#endif
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const uint8_t *pBitmap, const unsigned int Size)
 {
+	ST7565_WaitBlit();
+	if (Line > 0 && Line <= FRAME_LINES)
+		gLinesInSync &= ~(1u << (Line - 1));
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	DrawLine(Column, Line, pBitmap, Size);
 	SPI_ToggleMasterMode(&SPI0->CR, true);
@@ -52,24 +198,67 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
 
 void ST7565_BlitFullScreen(void)
 {
+	ST7565_WaitBlit();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	ST7565_WriteByte(0x40);
 	for (unsigned line = 0; line < FRAME_LINES; line++) {
 		DrawLine(0, line+1, gFrameBuffer[line], LCD_WIDTH);
+		SyncLine(line);
 	}
 	SPI_ToggleMasterMode(&SPI0->CR, true);
 }
 
+void ST7565_Flush(void)
+{
+	unsigned saved = 0;
+
+	ST7565_WaitBlit();
+	SPI_ToggleMasterMode(&SPI0->CR, false);
+	ST7565_WriteByte(0x40);
+	for (unsigned line = 0; line < FRAME_LINES; line++) {
+		const bool synced = gLinesInSync & (1u << line);
+		unsigned   first  = ST7565_SPANS;   // start of the current run of changed spans
+
+		for (unsigned span = 0; span <= ST7565_SPANS; span++) {
+			bool changed = false;
+
+			if (span < ST7565_SPANS) {
+				const uint32_t hash = HashSpan(&gFrameBuffer[line][span * ST7565_SPAN_WIDTH]);
+				changed = !synced || hash != gSpanHash[line][span];
+				gSpanHash[line][span] = hash;
+				if (!changed)
+					saved += ST7565_SPAN_WIDTH;
+			}
+
+			if (changed) {
+				if (first == ST7565_SPANS)
+					first = span;
+			} else if (first < ST7565_SPANS) {
+				const unsigned column = first * ST7565_SPAN_WIDTH;
+				DrawLine(column, line + 1, &gFrameBuffer[line][column], (span - first) * ST7565_SPAN_WIDTH);
+				first = ST7565_SPANS;
+			}
+		}
+		gLinesInSync |= 1u << line;
+	}
+	SPI_ToggleMasterMode(&SPI0->CR, true);
+
+	gST7565_FlushSavedBytes = saved;
+}
+
 void ST7565_BlitLine(unsigned line)
 {
+	ST7565_WaitBlit();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	ST7565_WriteByte(0x40);    // start line ?
 	DrawLine(0, line+1, gFrameBuffer[line], LCD_WIDTH);
+	SyncLine(line);
 	SPI_ToggleMasterMode(&SPI0->CR, true);
 }
 
 void ST7565_BlitStatusLine(void)
 {	// the top small text line on the display
+	ST7565_WaitBlit();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	ST7565_WriteByte(0x40);    // start line ?
 	DrawLine(0, 0, gStatusLine, LCD_WIDTH);
@@ -78,11 +267,13 @@ void ST7565_BlitStatusLine(void)
 
 void ST7565_FillScreen(uint8_t value)
 {
+	ST7565_WaitBlit();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	for (unsigned i = 0; i < 8; i++) {
 		DrawLine(0, i, NULL, value);
 	}
 	SPI_ToggleMasterMode(&SPI0->CR, true);
+	gLinesInSync = 0;
 }
 
 // Software reset
@@ -153,6 +344,9 @@ uint8_t cmds[] = {
 void ST7565_Init(void)
 {
 	SPI0_Init();
+#ifdef ENABLE_LCD_DMA
+	NVIC_EnableIRQ((IRQn_Type)DP32_DMA_IRQn);
+#endif
 	ST7565_HardwareReset();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	ST7565_WriteByte(ST7565_CMD_SOFTWARE_RESET);   // software reset
@@ -187,6 +381,8 @@ void ST7565_Init(void)
 
 void ST7565_FixInterfGlitch(void)
 {
+	ST7565_WaitBlit();
+	gLinesInSync = 0;   // the LCD RAM may be garbled as well, resend it all
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	for(uint8_t i = 0; i < ARRAY_SIZE(cmds); i++)
 		ST7565_WriteByte(cmds[i]);
@@ -26,9 +26,22 @@
 
 extern uint8_t gStatusLine[LCD_WIDTH];
 extern uint8_t gFrameBuffer[FRAME_LINES][LCD_WIDTH];
+extern uint16_t gST7565_FlushSavedBytes;   // bytes the last ST7565_Flush() did not need to send
 
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const uint8_t *pBitmap, const unsigned int Size);
 void ST7565_BlitFullScreen(void);
+void ST7565_Flush(void);
+#ifdef ENABLE_LCD_DMA
+	// starts a DMA blit of gFrameBuffer and returns straight away, the
+	// frame buffer must not be touched until ST7565_IsBlitBusy() is false
+	void ST7565_BlitFullScreenAsync(void);
+	bool ST7565_IsBlitBusy(void);
+	void ST7565_WaitBlit(void);
+#else
+	#define ST7565_BlitFullScreenAsync() ST7565_BlitFullScreen()
+	static inline bool ST7565_IsBlitBusy(void) { return false; }
+	static inline void ST7565_WaitBlit(void) {}
+#endif
 void ST7565_BlitLine(unsigned line);
 void ST7565_BlitStatusLine(void);
 void ST7565_FillScreen(uint8_t Value);
@@ -21,10 +21,132 @@
 // 0x20000324
 static uint32_t gTickMultiplier;
 
+#define TICK_CYCLES (SYSTICK_CORE_CLOCK_MHZ * 10000U)   // 10ms
+
+// cycles from the second VAL read in SYSTICK_TakeTicks() to the counter
+// restarting from LOAD, about: two SUBS, the LOAD and VAL stores and the
+// reload clock
+#define RESTART_CYCLES 7U
+
+// a cut period is at least this long, so the handler is done with the ticks
+// and has set LOAD for the one after before it ends
+#define SHORTEST_CYCLES (TICK_CYCLES / 16U)
+
+// 10ms ticks covered by the SysTick period running now, by the one LOAD holds
+// for the next reload, and the most power save asks for
+volatile uint8_t        gSysTickStretch = 1;
+static uint8_t          gSysTickLoaded  = 1;
+static volatile uint8_t gSysTickWanted  = 1;
+
 void SYSTICK_Init(void)
 {
-	SysTick_Config(480000);
-	gTickMultiplier = 48;
+	SysTick_Config(TICK_CYCLES);
+	gTickMultiplier = SYSTICK_CORE_CLOCK_MHZ;
+}
+
+// longer SysTick period for power save. Longer periods start at the next
+// reload, a shorter one cuts the running period at its next 10ms edge from
+// the handler, so the time base keeps every cycle
+void SYSTICK_SetStretch(uint8_t Stretch)
+{
+	gSysTickWanted = Stretch;
+
+	if (Stretch < gSysTickStretch || Stretch < gSysTickLoaded)
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+}
+
+// from the SysTick handler: the 10ms ticks that passed since the last call
+uint8_t SYSTICK_TakeTicks(void)
+{
+	uint8_t Ticks = 0;
+
+	// set by the reload, so clear when SYSTICK_SetStretch() pended us
+	if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) {
+		Ticks           = gSysTickStretch;
+		gSysTickStretch = gSysTickLoaded;
+	}
+
+	if (gSysTickWanted >= gSysTickStretch)
+		return Ticks;
+
+	const uint32_t First   = SysTick->VAL;
+	const uint32_t Elapsed = (gSysTickStretch * TICK_CYCLES) - 1U - First;
+	uint32_t       Left    = TICK_CYCLES - (Elapsed % TICK_CYCLES);
+	uint8_t        Early   = 0;
+
+	// too close to the edge to cut there: count that tick now, a little
+	// early, and cut at the one after
+	if (Left < SHORTEST_CYCLES) {
+		Left += TICK_CYCLES;
+		Early = 1;
+	}
+
+	const uint32_t Second = SysTick->VAL;
+
+	// reloaded meanwhile, count that period, the pending interrupt brings us back
+	if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) {
+		Ticks          += gSysTickStretch;
+		gSysTickStretch = gSysTickLoaded;
+		return Ticks;
+	}
+
+	// restart so the interrupt lands on the 10ms edge, the ticks already
+	// passed count now and the cycles spent here come off the cut period
+	SysTick->LOAD = Left - (First - Second) - RESTART_CYCLES - 1U;
+	SysTick->VAL  = 0;
+	while (SysTick->VAL == 0) {
+	}
+	SysTick->LOAD = (TICK_CYCLES * gSysTickLoaded) - 1U;
+
+	gSysTickStretch = 1;
+
+	return Ticks + (Elapsed / TICK_CYCLES) + Early;
+}
+
+// from the SysTick handler once the ticks ran: the period after the running
+// one ends no later than Deadline, 10ms ticks from now
+void SYSTICK_PlanNext(uint32_t Deadline)
+{
+	uint32_t Next = gSysTickWanted;
+
+	if (Deadline <= gSysTickStretch)
+		Next = 1;
+	else if (Deadline - gSysTickStretch < Next)
+		Next = Deadline - gSysTickStretch;
+
+	if (Next != gSysTickLoaded) {
+		SysTick->LOAD  = (TICK_CYCLES * Next) - 1U;
+		gSysTickLoaded = Next;
+	}
+}
+
+// waits for the next interrupt, returns the core cycles spent asleep
+uint32_t SYSTICK_Sleep(void)
+{
+	const uint32_t Before = SysTick->VAL;
+
+	__WFI();
+
+	const uint32_t After = SysTick->VAL;
+
+	// SysTick counts down and reloads at most once before we wake up
+	return (Before >= After) ? Before - After : Before + SysTick->LOAD + 1 - After;
+}
+
+uint32_t SYSTICK_GetCount(void)
+{
+	return SysTick->VAL;
+}
+
+uint32_t SYSTICK_CyclesSince(uint32_t *pPrevious)
+{
+	const uint32_t Previous = *pPrevious;
+	const uint32_t Current  = SysTick->VAL;
+
+	*pPrevious = Current;
+
+	// SysTick counts down and reloads from LOAD
+	return (Previous >= Current) ? Previous - Current : Previous + SysTick->LOAD + 1 - Current;
 }
 
 void SYSTICK_DelayUs(uint32_t Delay)
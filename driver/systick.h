@@ -19,8 +19,48 @@
 
 #include <stdint.h>
 
+// core clock, SysTick counts straight off it
+#define SYSTICK_CORE_CLOCK_MHZ  48U
+
+// one pass of the SYSTICK_DelayLoops() loop is SUBS (1 cycle) + taken BNE
+// (3 cycles) on the M0, the last BNE falls through in 1 and a MOVS loads the
+// count, so n loops take 4n - 1 cycles. Flash wait states can only add to it
+#define SYSTICK_CYCLES_PER_LOOP 4U
+#define SYSTICK_LOOPS_TO_CYCLES(n) ((n) * SYSTICK_CYCLES_PER_LOOP - 1U)
+
+// the fewest loops lasting ns, rounded up against 4n - 1, at least 1
+#define SYSTICK_NS_TO_LOOPS(ns)                                                          \
+	((((ns) * SYSTICK_CORE_CLOCK_MHZ) + 1000U + (1000U * SYSTICK_CYCLES_PER_LOOP) - 1U) / \
+	 (1000U * SYSTICK_CYCLES_PER_LOOP))
+
+extern volatile uint8_t gSysTickStretch;
+
 void SYSTICK_Init(void);
 void SYSTICK_DelayUs(uint32_t Delay);
+void SYSTICK_SetStretch(uint8_t Stretch);
+uint8_t SYSTICK_TakeTicks(void);
+void SYSTICK_PlanNext(uint32_t Deadline);
+uint32_t SYSTICK_Sleep(void);
+
+// stopwatch that runs with IRQs off too: start from SYSTICK_GetCount(), then
+// SYSTICK_CyclesSince() returns the core cycles since the last reading, it
+// must be called at least once per SysTick period
+uint32_t SYSTICK_GetCount(void);
+uint32_t SYSTICK_CyclesSince(uint32_t *pPrevious);
+
+// cycle counted busy wait for the bit-banged buses, SYSTICK_DelayUs() costs
+// more in call and SysTick polling overhead than the edge time it waits for
+static inline __attribute__((always_inline)) void SYSTICK_DelayLoops(uint32_t Loops)
+{
+	__asm volatile (
+		"1:	subs	%0, %0, #1	\n"
+		"	bne	1b		\n"
+		: "+l" (Loops)
+		:
+		: "cc");
+}
+
+#define SYSTICK_DelayNs(ns) SYSTICK_DelayLoops(SYSTICK_NS_TO_LOOPS(ns))
 
 #endif
 
@@ -15,7 +15,9 @@
  */
 
 #include <stdbool.h>
+#include "ARMCM0.h"
 #include "bsp/dp32g030/dma.h"
+#include "bsp/dp32g030/irq.h"
 #include "bsp/dp32g030/syscon.h"
 #include "bsp/dp32g030/uart.h"
 #include "driver/uart.h"
@@ -24,28 +26,54 @@
 static bool UART_IsLogEnabled;
 uint8_t UART_DMA_Buffer[256];
 
-void UART_Init(void)
+// TX ring, filled by UART_Write() and drained into the TX FIFO by the
+// UART1 interrupt, the uint8_t indexes wrap with the buffer
+static uint8_t          UART_TxRing[256];
+static volatile uint8_t UART_TxHead;
+static volatile uint8_t UART_TxTail;
+
+uint32_t UART_GetBaudDivisor(uint32_t RcFreqDelta, uint32_t BaudRate)
 {
-	uint32_t Delta;
 	uint32_t Positive;
 	uint32_t Frequency;
 
-	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
-	Delta = SYSCON_RC_FREQ_DELTA;
-	Positive = (Delta & SYSCON_RC_FREQ_DELTA_RCHF_SIG_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_SIG_SHIFT;
-	Frequency = (Delta & SYSCON_RC_FREQ_DELTA_RCHF_DELTA_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_DELTA_SHIFT;
+	Positive = (RcFreqDelta & SYSCON_RC_FREQ_DELTA_RCHF_SIG_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_SIG_SHIFT;
+	Frequency = (RcFreqDelta & SYSCON_RC_FREQ_DELTA_RCHF_DELTA_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_DELTA_SHIFT;
 	if (Positive) {
 		Frequency += 48000000U;
 	} else {
 		Frequency = 48000000U - Frequency;
 	}
 
+	// the stock divisor, kept exactly as it was
+	if (BaudRate == UART_BAUD_DEFAULT) {
+		return Frequency / 39053U;
+	}
+
 	// 48M, the baud rate is set to 115200, then UARTDIV=48000000/115200=416.6, 417 can be selected based on rounding.
-	UART1->BAUD = Frequency / 39053U;
-	//UART1->BAUD = 48000000U / 38400U;
-	
-	//UART1->BAUD = Frequency / 115200;
-	//UART1->BAUD = 48000000U / 128000;
+	// the other rates get the same 39053/38400 trim as the stock one, split
+	// up as 1 + 653/38400 so that BaudRate * 39053 can't overflow
+	const uint32_t Trimmed = BaudRate + (BaudRate * 653U + 38400U / 2) / 38400U;
+	return (Frequency + Trimmed / 2) / Trimmed;
+}
+
+void UART_SetBaudRate(uint32_t BaudRate)
+{
+	const uint32_t Divisor = UART_GetBaudDivisor(SYSCON_RC_FREQ_DELTA, BaudRate);
+
+	if (UART1->BAUD == Divisor) {
+		return;     // don't drop whatever is on the line for nothing
+	}
+
+	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
+	UART1->BAUD = Divisor;
+	UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
+}
+
+void UART_Init(void)
+{
+	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
+	UART1->BAUD = UART_GetBaudDivisor(SYSCON_RC_FREQ_DELTA, UART_BAUD_DEFAULT);
 
 	UART1->CTRL = UART_CTRL_RXEN_BITS_ENABLE | UART_CTRL_TXEN_BITS_ENABLE | UART_CTRL_RXDMAEN_BITS_ENABLE;
 	UART1->RXTO = 4;
@@ -89,24 +117,94 @@ void UART_Init(void)
 	DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
 
 	UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
+
+	NVIC_EnableIRQ((IRQn_Type)DP32_UART1_IRQn);
 }
 
-void UART_Send(const void *pBuffer, uint32_t Size)
+static void UART_FillTxFifo(void)
+{
+	uint8_t Tail = UART_TxTail;
+
+	while (Tail != UART_TxHead && (UART1->IF & UART_IF_TXFIFO_FULL_MASK) == UART_IF_TXFIFO_FULL_BITS_NOT_SET) {
+		UART1->TDR = UART_TxRing[Tail++];
+	}
+	UART_TxTail = Tail;
+	UART1->IF = UART_IF_TXFIFO_BITS_SET;
+
+	if (Tail == UART_TxHead) {
+		UART1->IE &= ~UART_IE_TXFIFO_MASK;
+	}
+}
+
+void HandlerUART1(void);
+
+void HandlerUART1(void)
+{
+	UART_FillTxFifo();
+}
+
+uint32_t UART_Write(const void *pBuffer, uint32_t Size)
 {
 	const uint8_t *pData = (const uint8_t *)pBuffer;
+	uint8_t Head = UART_TxHead;
 	uint32_t i;
 
-	for (i = 0; i < Size; i++) {
-		UART1->TDR = pData[i];
-		while ((UART1->IF & UART_IF_TXFIFO_FULL_MASK) != UART_IF_TXFIFO_FULL_BITS_NOT_SET) {
-		}
+	for (i = 0; i < Size && (uint8_t)(Head + 1) != UART_TxTail; i++) {
+		UART_TxRing[Head++] = pData[i];
+	}
+	UART_TxHead = Head;
+
+	if (i > 0) {
+		UART1->IE |= UART_IE_TXFIFO_BITS_ENABLE;
+	}
+
+	return i;
+}
+
+uint32_t UART_TxFree(void)
+{
+	return (uint8_t)(UART_TxTail - UART_TxHead - 1);
+}
+
+bool UART_IsTxIdle(void)
+{
+	return UART_TxTail == UART_TxHead && (UART1->IF & UART_IF_TXBUSY_MASK) == UART_IF_TXBUSY_BITS_NOT_SET;
+}
+
+static void UART_DrainTxRing(void)
+{	// the commands are handled with interrupts off, so push the ring out
+	// from here rather than waiting for the interrupt
+	const uint32_t Primask = __get_PRIMASK();
+	__disable_irq();
+	UART_FillTxFifo();
+	__set_PRIMASK(Primask);
+}
+
+void UART_WaitTxDone(void)
+{
+	while (!UART_IsTxIdle())
+		UART_DrainTxRing();
+}
+
+void UART_Send(const void *pBuffer, uint32_t Size)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+
+	// only waits while the ring is full
+	while (Size > 0) {
+		const uint32_t Written = UART_Write(pData, Size);
+		pData += Written;
+		Size  -= Written;
+
+		if (Written == 0)
+			UART_DrainTxRing();
 	}
 }
 
 void UART_LogSend(const void *pBuffer, uint32_t Size)
 {
 	if (UART_IsLogEnabled) {
-		UART_Send(pBuffer, Size);
+		UART_Write(pBuffer, Size);   // log output is dropped rather than waited for
 	}
 }
 
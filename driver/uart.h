@@ -18,12 +18,27 @@
 #ifndef DRIVER_UART_H
 #define DRIVER_UART_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#define UART_BAUD_DEFAULT  38400U
+// the RX DMA ring is 256 bytes and gets read once per 10ms tick, at 115200
+// a tick brings 115 bytes, twice that would lap the ring between reads
+#define UART_BAUD_MAX      115200U
+
 extern uint8_t UART_DMA_Buffer[256];
 
 void UART_Init(void);
+// UART1->BAUD value for BaudRate, RcFreqDelta is the SYSCON_RC_FREQ_DELTA trim
+uint32_t UART_GetBaudDivisor(uint32_t RcFreqDelta, uint32_t BaudRate);
+void UART_SetBaudRate(uint32_t BaudRate);
+// queues as much as fits in the TX ring and returns the count, never waits
+uint32_t UART_Write(const void *pBuffer, uint32_t Size);
+// queues all of it, waiting for the ring to drain if it has to
 void UART_Send(const void *pBuffer, uint32_t Size);
+uint32_t UART_TxFree(void);
+bool UART_IsTxIdle(void);
+void UART_WaitTxDone(void);
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 
 void UART_printf(const char *str, ...);
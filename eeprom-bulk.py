@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+
+# Reads or writes the radio EEPROM with the bulk transfer commands of a
+# firmware built with ENABLE_UART (0x0540..0x0544, see app/uart.c):
+#
+#   eeprom-bulk.py <serial port> read <file> [offset [length]]
+#   eeprom-bulk.py <serial port> write <file> [offset]
+#
+# --baud 115200 switches the link up for the transfer, the radio goes back
+# to 38400 on its own when the session ends. Needs pyserial.
+
+import argparse
+import random
+import struct
+import sys
+import time
+
+OBFUSCATION = bytes([
+        0x16, 0x6C, 0x14, 0xE6, 0x2E, 0x91, 0x0D, 0x40, 0x21, 0x35, 0xD5, 0x40, 0x13, 0x03, 0xE9, 0x80,
+    ])
+
+EEPROM_SIZE = 0x2000
+FRAME_SIZE  = 128
+READ_WINDOW = 16
+RETRIES     = 10
+
+def crc16_xmodem(data, crc=0):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+def obfuscate(data):
+    return bytes(b ^ OBFUSCATION[i % 16] for i, b in enumerate(data))
+
+def frame(cmd_id, body):
+    payload = struct.pack('<HH', cmd_id, len(body)) + body
+    crc = struct.pack('<H', crc16_xmodem(payload))
+    return b'\xAB\xCD' + struct.pack('<H', len(payload)) + obfuscate(payload + crc) + b'\xDC\xBA'
+
+class SerialLink:
+    def __init__(self, path, baud):
+        import serial
+        self.port = serial.Serial(path, baud, timeout=0.05)
+
+    def read(self, size):
+        return self.port.read(max(1, min(size, self.port.in_waiting)))
+
+    def write(self, data):
+        self.port.write(data)
+
+    def set_baud(self, baud):
+        self.port.flush()
+        self.port.baudrate = baud
+
+class Radio:
+    def __init__(self, link):
+        self.link = link
+        self.buf = b''
+        self.timestamp = random.getrandbits(32)
+
+    def send(self, cmd_id, body=b''):
+        self.link.write(frame(cmd_id, body))
+
+    def parse(self):
+        while True:
+            start = self.buf.find(b'\xAB\xCD')
+            if start < 0:
+                self.buf = self.buf[-1:]
+                return None
+            self.buf = self.buf[start:]
+            if len(self.buf) < 4:
+                return None
+            size, = struct.unpack_from('<H', self.buf, 2)
+            if len(self.buf) < size + 8:
+                return None
+            if size < 4 or self.buf[size + 6:size + 8] != b'\xDC\xBA':
+                self.buf = self.buf[2:]   # not a reply after all
+                continue
+            payload = obfuscate(self.buf[4:4 + size])
+            self.buf = self.buf[size + 8:]
+            cmd_id, = struct.unpack_from('<H', payload)
+            return cmd_id, payload[4:]
+
+    # next reply with one of the IDs, None after timeout seconds of nothing
+    def wait(self, ids, timeout=0.5):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            reply = self.parse()
+            if reply is None:
+                self.buf += self.link.read(256)
+            elif reply[0] in ids:
+                return reply
+        return None
+
+    def hello(self):
+        for _ in range(RETRIES):
+            self.send(0x0514, struct.pack('<I', self.timestamp))
+            reply = self.wait((0x0515,))
+            if reply:
+                return reply[1][:16].split(b'\0')[0].decode('ascii', 'replace')
+        raise IOError('no answer from the radio')
+
+    def set_baud(self, baud):
+        self.send(0x05E1, struct.pack('<II', baud, self.timestamp))
+        reply = self.wait((0x05E2,))
+        if not reply or struct.unpack_from('<I', reply[1])[0] != baud:
+            raise IOError('the radio does not take %d baud' % baud)
+        self.link.set_baud(baud)
+        # the radio waits a second for this at the new rate
+        for _ in range(3):
+            self.send(0x05E3)
+            if self.wait((0x05E4,), 0.25):
+                return
+        raise IOError('lost the radio switching to %d baud' % baud)
+
+    def read(self, offset, length, progress=None):
+        frames = (length + FRAME_SIZE - 1) // FRAME_SIZE
+        got = {}
+        reported = {}   # missing frame -> when it was last asked for
+        highest = -1
+        start = struct.pack('<HHB3xI', offset, length, READ_WINDOW, self.timestamp)
+        self.send(0x0540, start)
+        stalls = 0
+        while len(got) < frames:
+            reply = self.wait((0x0541,), 1.5)
+            if reply is None:
+                # the radio sends everything outstanding again after a
+                # second, when even that doesn't come start over
+                stalls += 1
+                if stalls > RETRIES:
+                    raise IOError('read stalled at frame %d' % min(set(range(frames)) - set(got)))
+                self.send(0x0540, start)
+                continue
+            stalls = 0
+            seq, _, size, rejected = struct.unpack_from('<HHBB', reply[1])
+            if rejected:
+                raise IOError('the radio rejected reading %d bytes at 0x%04X' % (length, offset))
+            if seq < frames and seq not in got:
+                got[seq] = reply[1][6:6 + size]
+                if progress:
+                    progress(len(got) * FRAME_SIZE, length)
+            highest = max(highest, seq)
+            base = 0
+            while base in got:
+                base += 1
+            now = time.monotonic()
+            missing = 0
+            for n in range(16):
+                seq = base + n
+                if seq < highest and seq not in got and now - reported.get(seq, 0) > 0.5:
+                    missing |= 1 << n
+                    reported[seq] = now
+            self.send(0x0542, struct.pack('<HHI', base, missing, self.timestamp))
+        return b''.join(got[seq] for seq in range(frames))[:length]
+
+    def write(self, offset, data, progress=None):
+        if offset % 8 or len(data) % 8:
+            raise ValueError('writes go in 8 byte blocks')
+        frames = [data[i:i + FRAME_SIZE] for i in range(0, len(data), FRAME_SIZE)]
+        window = 1      # until the radio says otherwise
+        acked = set()
+        sent = {}       # frame -> when it went out
+        retries = 0
+        while len(acked) < len(frames):
+            now = time.monotonic()
+            pending = [seq for seq in range(len(frames)) if seq not in acked]
+            for seq in pending[:window]:
+                if now - sent.get(seq, 0) > 0.5:
+                    chunk = frames[seq]
+                    body = struct.pack('<HHBB2xI', seq, offset + seq * FRAME_SIZE, len(chunk), 0, self.timestamp)
+                    self.send(0x0543, body + chunk)
+                    sent[seq] = now
+            reply = self.wait((0x0544,), 0.5)
+            if reply is None:
+                retries += 1
+                if retries > RETRIES:
+                    raise IOError('write stalled at frame %d' % pending[0])
+                continue
+            retries = 0
+            seq, _, window, rejected = struct.unpack_from('<HHBB', reply[1])
+            if rejected:
+                raise IOError('the radio rejected write frame %d at 0x%04X' % (seq, offset + seq * FRAME_SIZE))
+            window = max(1, window)
+            if seq < len(frames) and seq not in acked:
+                acked.add(seq)
+                if progress:
+                    progress(len(acked) * FRAME_SIZE, len(data))
+
+def main(argv, link=None):
+    parser = argparse.ArgumentParser(description='bulk EEPROM transfers over the UART')
+    parser.add_argument('port')
+    parser.add_argument('action', choices=('read', 'write'))
+    parser.add_argument('file')
+    parser.add_argument('offset', nargs='?', default='0', type=lambda x: int(x, 0))
+    parser.add_argument('length', nargs='?', type=lambda x: int(x, 0))
+    parser.add_argument('--baud', type=int, default=38400)
+    parser.add_argument('--quiet', action='store_true')
+    args = parser.parse_args(argv)
+
+    def progress(done, total):
+        if not args.quiet:
+            print('\r%5d/%d bytes' % (min(done, total), total), end='', file=sys.stderr, flush=True)
+
+    radio = Radio(link or SerialLink(args.port, 38400))
+    version = radio.hello()
+    if args.baud != 38400:
+        radio.set_baud(args.baud)
+
+    started = time.monotonic()
+    if args.action == 'read':
+        length = args.length if args.length is not None else EEPROM_SIZE - args.offset
+        data = radio.read(args.offset, length, progress)
+        open(args.file, 'wb').write(data)
+    else:
+        data = open(args.file, 'rb').read()
+        radio.write(args.offset, data, progress)
+    seconds = time.monotonic() - started
+
+    if not args.quiet:
+        print('\r%s: %d bytes in %.1fs, %.0f bytes/s' % (version, len(data), seconds, len(data) / seconds), file=sys.stderr)
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
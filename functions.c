@@ -37,14 +37,19 @@
 #include "frequencies.h"
 #include "functions.h"
 #include "helper/battery.h"
+#include "helper/pt.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/status.h"
 #include "ui/ui.h"
 
 FUNCTION_Type_t gCurrentFunction;
 
+static PT_t gKeyUpThread;
+static PT_t gKeyUpTones;
+
 bool FUNCTION_IsRx()
 {
 	return gCurrentFunction == FUNCTION_MONITOR ||
@@ -61,7 +66,7 @@ void FUNCTION_Init(void)
 	g_SquelchLost      = false;
 
 	gFlagTailToneEliminationComplete   = false;
-	gTailToneEliminationCountdown_10ms = 0;
+	TIMER_Stop(TIMER_TAIL_TONE);
 	gFoundCTCSS                        = false;
 	gFoundCDCSS                        = false;
 	gFoundCTCSSCountdown_10ms          = 0;
@@ -121,7 +126,7 @@ void FUNCTION_Foreground(const FUNCTION_Type_t PreviousFunction)
 }
 
 void FUNCTION_PowerSave() {
-	gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+	TIMER_Start(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
 	gPowerSaveCountdownExpired = false;
 
 	gRxIdleMode = true;
@@ -139,28 +144,12 @@ void FUNCTION_PowerSave() {
 		GUI_SelectNextDisplay(DISPLAY_MAIN);
 }
 
-void FUNCTION_Transmit()
+// the part of the key-up that plays tones, resumed every 10ms
+static bool FUNCTION_KeyUpThread(void)
 {
+	PT_t *pt = &gKeyUpThread;
 
-#ifdef ENABLE_MESSENGER
-	MSG_EnableRX(false);	
-#endif	
-	// if DTMF is enabled when TX'ing, it changes the TX audio filtering !! .. 1of11
-	BK4819_DisableDTMF();
-
-#ifdef ENABLE_DTMF_CALLING
-	// clear the DTMF RX buffer
-	DTMF_clear_RX();
-#endif
-
-	// clear the DTMF RX live decoder buffer
-	gDTMF_RX_live_timeout = 0;
-	memset(gDTMF_RX_live, 0, sizeof(gDTMF_RX_live));
-
-#if defined(ENABLE_FMRADIO)
-	if (gFmRadioMode)
-		BK1080_Init0();
-#endif
+	PT_BEGIN(pt);
 
 #ifdef ENABLE_ALARM
 	if (gAlarmState == ALARM_STATE_SITE_ALARM)
@@ -169,7 +158,7 @@ void FUNCTION_Transmit()
 
 		AUDIO_AudioPathOff();
 
-		SYSTEM_DelayMs(20);
+		PT_DELAY_MS(pt, 20);
 		BK4819_PlayTone(500, 0);
 		SYSTEM_DelayMs(2);
 
@@ -177,11 +166,11 @@ void FUNCTION_Transmit()
 
 		gEnableSpeaker = true;
 
-		SYSTEM_DelayMs(60);
+		PT_DELAY_MS(pt, 60);
 		BK4819_ExitTxMute();
 
 		gAlarmToneCounter = 0;
-		return;
+		PT_EXIT(pt);
 	}
 #endif
 
@@ -194,21 +183,21 @@ void FUNCTION_Transmit()
 	// turn the RED LED on
 	BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
 
-	DTMF_Reply();
+	PT_SPAWN(pt, &gKeyUpTones, DTMF_Reply(&gKeyUpTones));
 
 	if (gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_APOLLO)
-		BK4819_PlaySingleTone(2525, 250, 0, gEeprom.DTMF_SIDE_TONE);
+		PT_SPAWN(pt, &gKeyUpTones, BK4819_PlaySingleTone(&gKeyUpTones, 2525, 250, 0, gEeprom.DTMF_SIDE_TONE));
 
 #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
 	if (gAlarmState != ALARM_STATE_OFF) {
 		#ifdef ENABLE_TX1750
 		if (gAlarmState == ALARM_STATE_TX1750)
-			BK4819_TransmitTone(true, 1750);
+			PT_SPAWN(pt, &gKeyUpTones, BK4819_TransmitTone(&gKeyUpTones, true, 1750));
 		#endif
 
 		#ifdef ENABLE_ALARM
 		if (gAlarmState == ALARM_STATE_TXALARM)
-			BK4819_TransmitTone(true, 500);
+			PT_SPAWN(pt, &gKeyUpTones, BK4819_TransmitTone(&gKeyUpTones, true, 500));
 
 		gAlarmToneCounter = 0;
 		#endif
@@ -217,7 +206,7 @@ void FUNCTION_Transmit()
 		AUDIO_AudioPathOn();
 		gEnableSpeaker = true;
 
-		return;
+		PT_EXIT(pt);
 	}
 #endif
 
@@ -229,6 +218,58 @@ void FUNCTION_Transmit()
 	if (gSetting_backlight_on_tx_rx & BACKLIGHT_ON_TR_TX) {
 		BACKLIGHT_TurnOn();
 	}
+
+	PT_END(pt);
+}
+
+void FUNCTION_Transmit()
+{
+
+#ifdef ENABLE_MESSENGER
+	MSG_EnableRX(false);	
+#endif	
+	// if DTMF is enabled when TX'ing, it changes the TX audio filtering !! .. 1of11
+	BK4819_DisableDTMF();
+
+#ifdef ENABLE_DTMF_CALLING
+	// clear the DTMF RX buffer
+	DTMF_clear_RX();
+#endif
+
+	// clear the DTMF RX live decoder buffer
+	gDTMF_RX_live_timeout = 0;
+	memset(gDTMF_RX_live, 0, sizeof(gDTMF_RX_live));
+
+#if defined(ENABLE_FMRADIO)
+	if (gFmRadioMode)
+		BK1080_Init0();
+#endif
+
+	// the PTT ID and alarm tones play on from APP_TimeSlice10ms
+	PT_INIT(&gKeyUpThread);
+	FUNCTION_KeyUpThread();
+}
+
+// resumes the key-up tones, called every 10ms
+void FUNCTION_ServiceKeyUp(void)
+{
+	if (PT_IsRunning(&gKeyUpThread))
+		FUNCTION_KeyUpThread();
+}
+
+// plays the rest of the key-up tones in place
+void FUNCTION_FinishKeyUp(void)
+{
+	if (!PT_IsRunning(&gKeyUpThread))
+		return;
+
+	gKeyUpThread.bBlocking = true;
+	FUNCTION_KeyUpThread();
+}
+
+bool FUNCTION_IsKeyingUp(void)
+{
+	return PT_IsRunning(&gKeyUpThread);
 }
 
 
@@ -238,6 +279,9 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 	const FUNCTION_Type_t PreviousFunction = gCurrentFunction;
 	const bool bWasPowerSave = PreviousFunction == FUNCTION_POWER_SAVE;
 
+	AUDIO_FinishBeep();   // the beep restores BK4819 state we are about to change
+	FUNCTION_FinishKeyUp();   // so do the PTT ID tones, they go out before the TX drops
+
 	gCurrentFunction = Function;
 
 	if (bWasPowerSave && Function != FUNCTION_POWER_SAVE) {
@@ -270,7 +314,7 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 			break;
 	}
 
-	gBatterySaveCountdown_10ms = battery_save_count_10ms;
+	TIMER_Start(TIMER_BATTERY_SAVE, battery_save_count_10ms);
 	gSchedulePowerSave         = false;
 
 #if defined(ENABLE_FMRADIO)
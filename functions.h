@@ -17,6 +17,7 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 enum FUNCTION_Type_t
@@ -38,5 +39,8 @@ extern FUNCTION_Type_t       gCurrentFunction;
 void FUNCTION_Init(void);
 void FUNCTION_Select(FUNCTION_Type_t Function);
 bool FUNCTION_IsRx();
+void FUNCTION_ServiceKeyUp(void);
+void FUNCTION_FinishKeyUp(void);
+bool FUNCTION_IsKeyingUp(void);
 
 #endif
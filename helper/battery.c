@@ -17,6 +17,7 @@
 #include <assert.h>
 
 #include "battery.h"
+#include "board.h"
 #include "driver/backlight.h"
 #include "driver/st7565.h"
 #include "functions.h"
@@ -29,7 +30,6 @@
 uint16_t          gBatteryCalibration[6];
 uint16_t          gBatteryCurrentVoltage;
 uint16_t          gBatteryCurrent;
-uint16_t          gBatteryVoltages[4];
 uint16_t          gBatteryVoltageAverage;
 uint8_t           gBatteryDisplayLevel;
 bool              gChargingWithTypeC;
@@ -48,9 +48,6 @@ typedef enum {
 uint16_t          lowBatteryCountdown;
 const uint16_t 	  lowBatteryPeriod = 30;
 
-volatile uint16_t gPowerSave_10ms;
-
-
 const uint16_t Voltage2PercentageTable[][7][2] = {
 	[BATTERY_TYPE_1600_MAH] = {
 		{828, 100},
@@ -96,7 +93,9 @@ unsigned int BATTERY_VoltsToPercent(const unsigned int voltage_10mV)
 void BATTERY_GetReadings(const bool bDisplayBatteryLevel)
 {
 	const uint8_t  PreviousBatteryLevel = gBatteryDisplayLevel;
-	const uint16_t Voltage              = (gBatteryVoltages[0] + gBatteryVoltages[1] + gBatteryVoltages[2] + gBatteryVoltages[3]) / 4;
+	uint16_t       Voltage;
+
+	BOARD_ADC_GetBatteryInfo(&Voltage, &gBatteryCurrent);
 
 	gBatteryVoltageAverage = (Voltage * 760) / gBatteryCalibration[3];
 
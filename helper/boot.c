@@ -60,11 +60,6 @@ BOOT_Mode_t BOOT_GetMode(void)
 
 	if (Keys[0] == Keys[1])
 	{
-		gKeyReading0 = Keys[0];
-		gKeyReading1 = Keys[0];
-
-		gDebounceCounter = 2;
-
 		if (Keys[0] == KEY_SIDE1)
 			return BOOT_MODE_F_LOCK;
 
@@ -0,0 +1,108 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef PT_H
+#define PT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/system.h"
+#include "misc.h"
+
+// Stackless cooperative threads (protothreads).
+//
+// A thread is a function returning bool, true while it still has work to do.
+// It is resumed from APP_TimeSlice10ms and picks up at the line it last
+// yielded on, so locals do NOT survive a yield - keep state in statics.
+// Don't put PT_* waits inside a switch of your own, the resume point is a
+// case label of the switch opened by PT_BEGIN.
+//
+// Setting bBlocking makes every wait spin in place instead of yielding, used
+// to run a thread to completion where the caller can't come back later. The
+// spin polls the SysTick counter register, so it also works with IRQs off.
+
+typedef struct {
+	uint16_t Line;
+	bool     bBlocking;
+	uint32_t Wake;      // gGlobalSysTickCounter value ending a PT_DELAY_MS
+} PT_t;
+
+static inline bool PT_Expired(const PT_t *pt)
+{
+	return (int32_t)(gGlobalSysTickCounter - pt->Wake) >= 0;
+}
+
+#define PT_INIT(pt)          do { (pt)->Line = 0; (pt)->bBlocking = false; } while (0)
+#define PT_IsRunning(pt)     ((pt)->Line != 0)
+
+#define PT_BEGIN(pt)         switch ((pt)->Line) { case 0:
+
+#define PT_END(pt)           } (pt)->Line = 0; return false
+
+#define PT_EXIT(pt)          do { (pt)->Line = 0; return false; } while (0)
+
+#define PT_YIELD(pt)                                                   \
+	do {                                                               \
+		if (!(pt)->bBlocking) {                                        \
+			(pt)->Line = __LINE__; return true; case __LINE__:;        \
+		}                                                              \
+	} while (0)
+
+#define PT_WAIT_UNTIL(pt, cond)                                        \
+	do {                                                               \
+		(pt)->Line = __LINE__; __attribute__((fallthrough));           \
+		case __LINE__:                                                 \
+		while (!(cond)) {                                              \
+			if (!(pt)->bBlocking)                                      \
+				return true;                                           \
+			SYSTEM_DelayMs(1);                                         \
+		}                                                              \
+	} while (0)
+
+// starts a child thread and waits for it to end, the child inherits bBlocking
+#define PT_SPAWN(pt, child, thread)                                    \
+	do {                                                               \
+		PT_INIT(child);                                                \
+		PT_WAIT_UNTIL(pt, ((child)->bBlocking = (pt)->bBlocking, !(thread))); \
+	} while (0)
+
+// runs a thread to its end in place, for callers that can't come back later
+#define PT_RUN(pt, thread)                                             \
+	do {                                                               \
+		PT_INIT(pt);                                                   \
+		(pt)->bBlocking = true;                                        \
+		(void)(thread);                                                \
+	} while (0)
+
+// waits Ms, in whole 10ms ticks when yielding (threads resume right after a tick)
+#define PT_DELAY_MS(pt, Ms)                                            \
+	do {                                                               \
+		if ((pt)->bBlocking) {                                         \
+			SYSTEM_DelayMs(Ms);                                        \
+			break;                                                     \
+		}                                                              \
+		(pt)->Wake = gGlobalSysTickCounter + ((Ms) + 9) / 10;          \
+		(pt)->Line = __LINE__; __attribute__((fallthrough));           \
+		case __LINE__:                                                 \
+		if (!PT_Expired(pt)) {                                         \
+			if (!(pt)->bBlocking)                                      \
+				return true;                                           \
+			SYSTEM_DelayMs(((pt)->Wake - gGlobalSysTickCounter) * 10); \
+		}                                                              \
+	} while (0)
+
+#endif
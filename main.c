@@ -26,6 +26,7 @@
 #include "board.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "version.h"
 
@@ -78,6 +79,8 @@ void Main(void)
 
 	boot_counter_10ms = 250;   // 2.5 sec
 
+	TIMER_Start(TIMER_BATTERY_SAVE, battery_save_count_10ms);
+
 #ifdef ENABLE_UART
 	UART_Init();
 	UART_Send(UART_Version, strlen(UART_Version));
@@ -108,9 +111,6 @@ void Main(void)
 
 	RADIO_SetupRegisters(true);
 
-	for (unsigned int i = 0; i < ARRAY_SIZE(gBatteryVoltages); i++)
-		BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[i], &gBatteryCurrent);
-
 	BATTERY_GetReadings(false);
 
 #ifdef ENABLE_MESSENGER
@@ -152,9 +152,6 @@ void Main(void)
 			i = (GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT) && KEYBOARD_Poll() == KEY_INVALID) ? i + 1 : 0;
 			SYSTEM_DelayMs(10);
 		}
-		gKeyReading0 = KEY_INVALID;
-		gKeyReading1 = KEY_INVALID;
-		gDebounceCounter = 0;
 	}
 
 	if (!gChargingWithTypeC && gBatteryDisplayLevel == 0)
@@ -184,8 +181,10 @@ void Main(void)
 					break;
 				}
 #ifdef ENABLE_BOOT_BEEPS
-				if ((boot_counter_10ms % 25) == 0)
+				if ((boot_counter_10ms % 25) == 0) {
 					AUDIO_PlayBeep(BEEP_880HZ_40MS_OPTIONAL);
+					AUDIO_FinishBeep();
+				}
 #endif
 			}
 		}
@@ -240,5 +239,11 @@ void Main(void)
 				APP_TimeSlice500ms();
 			}
 		}
+#ifdef ENABLE_IDLE_SLEEP
+		else {
+			// APP_Update has had one more pass since the last tick, nothing left to do
+			APP_Idle();
+		}
+#endif
 	}
 }
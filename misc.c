@@ -111,30 +111,24 @@ uint16_t          gEEPROM_1F8C;
 
 ChannelAttributes_t gMR_ChannelAttributes[FREQ_CHANNEL_LAST + 1];
 
-volatile uint16_t gBatterySaveCountdown_10ms = battery_save_count_10ms;
-
 volatile bool     gPowerSaveCountdownExpired;
 volatile bool     gSchedulePowerSave;
 
 volatile bool     gScheduleDualWatch = true;
 
-volatile uint16_t gDualWatchCountdown_10ms;
 bool              gDualWatchActive           = false;
 
 volatile uint8_t  gSerialConfigCountDown_500ms;
+volatile uint8_t  gSerialBaudCountdown_10ms;
+volatile bool     gSerialBaudFallback;
 
 volatile bool     gNextTimeslice_500ms;
 
 volatile uint16_t gTxTimerCountdown_500ms;
 volatile bool     gTxTimeoutReached;
 
-volatile uint16_t gTailToneEliminationCountdown_10ms;
-
 volatile uint8_t    gVFOStateResumeCountdown_500ms;
 
-#ifdef ENABLE_NOAA
-	volatile uint16_t gNOAA_Countdown_10ms;
-#endif
 
 bool              gEnableSpeaker;
 uint8_t           gKeyInputCountdown = 0;
@@ -150,11 +144,9 @@ int16_t           gVFO_RSSI[2];
 uint8_t           gVFO_RSSI_bar_level[2];
 
 uint8_t           gReducedService;
-uint8_t           gBatteryVoltageIndex;
 bool     		  gCssBackgroundScan;
 
 volatile bool     gScheduleScanListen = true;
-volatile uint16_t gScanPauseDelayIn_10ms;
 
 #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
 	AlarmState_t  gAlarmState;
@@ -225,9 +217,6 @@ uint8_t           gShowChPrefix;
 volatile bool     gNextTimeslice;
 volatile uint8_t  gFoundCDCSSCountdown_10ms;
 volatile uint8_t  gFoundCTCSSCountdown_10ms;
-#ifdef ENABLE_VOX
-	volatile uint16_t gVoxStopCountdown_10ms;
-#endif
 volatile bool     gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
 	volatile uint16_t gNOAACountdown_10ms = 0;
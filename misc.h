@@ -191,28 +191,22 @@ typedef struct
 	int          dBmRssi;// RSSI in dBm
 }  __attribute__((packed))  sLevelAttributes;
 
-extern volatile uint16_t     gBatterySaveCountdown_10ms;
-
 extern volatile bool         gPowerSaveCountdownExpired;
 extern volatile bool         gSchedulePowerSave;
 
 extern volatile bool         gScheduleDualWatch;
 
-extern volatile uint16_t     gDualWatchCountdown_10ms;
 extern bool                  gDualWatchActive;
 
 extern volatile uint8_t      gSerialConfigCountDown_500ms;
+extern volatile uint8_t      gSerialBaudCountdown_10ms;
+extern volatile bool         gSerialBaudFallback;
 
 extern volatile bool         gNextTimeslice_500ms;
 
 extern volatile uint16_t     gTxTimerCountdown_500ms;
 extern volatile bool         gTxTimeoutReached;
 
-extern volatile uint16_t     gTailToneEliminationCountdown_10ms;
-
-#ifdef ENABLE_NOAA
-	extern volatile uint16_t gNOAA_Countdown_10ms;
-#endif
 extern bool                  gEnableSpeaker;
 extern uint8_t               gKeyInputCountdown;
 extern uint8_t               gKeyLockCountdown;
@@ -228,7 +222,6 @@ extern uint8_t               gVFO_RSSI_bar_level[2];
 
 // battery critical, limit functionality to minimum
 extern uint8_t               gReducedService;
-extern uint8_t               gBatteryVoltageIndex;
 
 // we are searching CTCSS/DCS inside RX ctcss/dcs menu
 extern bool         gCssBackgroundScan;
@@ -242,7 +235,6 @@ enum
 };
 
 extern volatile bool     gScheduleScanListen;
-extern volatile uint16_t gScanPauseDelayIn_10ms;
 
 extern AlarmState_t          gAlarmState;
 extern uint16_t              gMenuCountdown;
@@ -302,6 +294,7 @@ extern uint8_t               gFSKWriteIndex;
 	extern uint8_t           gNoaaChannel;
 #endif
 extern volatile bool         gNextTimeslice;
+extern volatile uint32_t     gGlobalSysTickCounter;
 extern bool                  gUpdateDisplay;
 extern bool                  gF_LOCK;
 #ifdef ENABLE_FMRADIO
@@ -310,9 +303,6 @@ extern bool                  gF_LOCK;
 extern uint8_t               gShowChPrefix;
 extern volatile uint8_t      gFoundCDCSSCountdown_10ms;
 extern volatile uint8_t      gFoundCTCSSCountdown_10ms;
-#ifdef ENABLE_VOX
-	extern volatile uint16_t gVoxStopCountdown_10ms;
-#endif
 extern volatile bool         gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
 	extern volatile uint16_t gNOAACountdown_10ms;
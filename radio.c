@@ -36,6 +36,7 @@
 #include "helper/battery.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/menu.h"
 
@@ -530,6 +531,8 @@ void RADIO_SetupRegisters(bool switchToForeground)
 {
 	BK4819_FilterBandwidth_t Bandwidth = gRxVfo->CHANNEL_BANDWIDTH;
 
+	AUDIO_FinishBeep();
+
 	AUDIO_AudioPathOff();
 
 	gEnableSpeaker = false;
@@ -746,7 +749,7 @@ void RADIO_SetupRegisters(bool switchToForeground)
 			{
 				gIsNoaaMode          = true;
 				gNoaaChannel         = gRxVfo->CHANNEL_SAVE - NOAA_CHANNEL_FIRST;
-				gNOAA_Countdown_10ms = NOAA_countdown_2_10ms;
+				TIMER_Start(TIMER_NOAA, NOAA_countdown_2_10ms);
 				gScheduleNOAA        = false;
 			}
 			else
@@ -895,7 +898,7 @@ void RADIO_PrepareTX(void)
 	if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
 	{	// dual-RX is enabled
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_tx_10ms;
+		TIMER_Start(TIMER_DUAL_WATCH, dual_watch_count_after_tx_10ms);
 		gScheduleDualWatch       = false;
 
 		if (!gRxVfoIsActive)
@@ -995,8 +998,10 @@ void RADIO_PrepareTX(void)
 #endif
 }
 
-void RADIO_SendCssTail(void)
+bool RADIO_SendCssTail(PT_t *pt)
 {
+	PT_BEGIN(pt);
+
 	switch (gCurrentVfo->pTX->CodeType) {
 	case CODE_TYPE_DIGITAL:
 	case CODE_TYPE_REVERSE_DIGITAL:
@@ -1007,28 +1012,42 @@ void RADIO_SendCssTail(void)
 		break;
 	}
 
-	SYSTEM_DelayMs(200);
+	PT_DELAY_MS(pt, 200);
+
+	PT_END(pt);
 }
 
-void RADIO_SendEndOfTransmission(void)
+// roger, PTT ID and CSS tail, the TX is still keyed meanwhile
+bool RADIO_SendEndOfTransmission(PT_t *pt)
 {
-	BK4819_PlayRoger();
-	DTMF_SendEndOfTransmission();
+	static PT_t ToneThread;
+
+	PT_BEGIN(pt);
+
+	PT_SPAWN(pt, &ToneThread, BK4819_PlayRoger(&ToneThread));
+	PT_SPAWN(pt, &ToneThread, DTMF_SendEndOfTransmission(&ToneThread));
 
 	// send the CTCSS/DCS tail tone - allows the receivers to mute the usual FM squelch tail/crash
 	if(gEeprom.TAIL_TONE_ELIMINATION)
-		RADIO_SendCssTail();
+		PT_SPAWN(pt, &ToneThread, RADIO_SendCssTail(&ToneThread));
 	RADIO_SetupRegisters(false);
+
+	PT_END(pt);
 }
 
 void RADIO_PrepareCssTX(void)
 {
+	PT_t Tail;
+
 	RADIO_PrepareTX();
 
+	// this runs inside FUNCTION_Select(), nothing can come back for it later
+	FUNCTION_FinishKeyUp();
+
 	SYSTEM_DelayMs(200);
 
 	if(gEeprom.TAIL_TONE_ELIMINATION)
-		RADIO_SendCssTail();
+		PT_RUN(&Tail, RADIO_SendCssTail(&Tail));
 	RADIO_SetupRegisters(true);
 }
 
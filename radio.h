@@ -22,6 +22,7 @@
 
 #include "dcs.h"
 #include "frequencies.h"
+#include "helper/pt.h"
 
 enum {
 	RADIO_CHANNEL_UP   = 0x01u,
@@ -164,8 +165,8 @@ void 	 RADIO_SetupAGC(bool listeningAM, bool disable);
 void     RADIO_SetModulation(ModulationMode_t modulation);
 void     RADIO_SetVfoState(VfoState_t State);
 void     RADIO_PrepareTX(void);
-void     RADIO_SendCssTail(void);
+bool     RADIO_SendCssTail(PT_t *pt);
 void     RADIO_PrepareCssTX(void);
-void     RADIO_SendEndOfTransmission(void);
+bool     RADIO_SendEndOfTransmission(PT_t *pt);
 
 #endif
@@ -14,18 +14,22 @@
  *     limitations under the License.
  */
 
+#include "ARMCM0.h"
 #include "app/chFrScanner.h"
 #ifdef ENABLE_FMRADIO
 	#include "app/fm.h"
 #endif
 #include "app/scanner.h"
 #include "audio.h"
+#include "board.h"
 #include "functions.h"
 #include "helper/battery.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 
 #include "driver/backlight.h"
+#include "driver/systick.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/gpio.h"
 
@@ -42,22 +46,154 @@
 				flag = true;             \
 	} while (0)
 
-static volatile uint32_t gGlobalSysTickCounter;
+volatile uint32_t gGlobalSysTickCounter;
+
+static volatile bool *const gTimerFlags[TIMER_COUNT] = {
+	[TIMER_BATTERY_SAVE] = &gSchedulePowerSave,
+	[TIMER_POWER_SAVE]   = &gPowerSaveCountdownExpired,
+	[TIMER_DUAL_WATCH]   = &gScheduleDualWatch,
+#ifdef ENABLE_NOAA
+	[TIMER_NOAA]         = &gScheduleNOAA,
+#endif
+	[TIMER_SCAN_PAUSE]   = &gScheduleScanListen,
+	[TIMER_TAIL_TONE]    = &gFlagTailToneEliminationComplete,
+#ifdef ENABLE_VOICE
+	[TIMER_VOICE]        = &gFlagPlayQueuedVoice,
+#endif
+#ifdef ENABLE_FMRADIO
+	[TIMER_FM_PLAY]      = &gScheduleFM,
+#endif
+};
+
+// a running timer holds its deadline tick, a paused one the ticks it has left
+static uint32_t gTimerValue[TIMER_COUNT];
+static uint16_t gTimerRunning;
+static uint16_t gTimerPaused = (1u << TIMER_COUNT) - 1u;
+static uint32_t gTimerNext;
+static bool     gTimerNextValid;
+
+static void TIMER_UpdateNext(void)
+{
+	const uint16_t Active = gTimerRunning & ~gTimerPaused;
+	uint32_t       Soonest = TIMER_NO_DEADLINE;
+
+	for (unsigned int i = 0; i < TIMER_COUNT; i++) {
+		if ((Active & (1u << i)) && (gTimerValue[i] - gGlobalSysTickCounter) < Soonest)
+			Soonest = gTimerValue[i] - gGlobalSysTickCounter;
+	}
+
+	gTimerNextValid = Soonest != TIMER_NO_DEADLINE;
+	gTimerNext      = gGlobalSysTickCounter + Soonest;
+}
+
+// Gates has a bit set for every timer that is allowed to count this tick
+static void TIMER_Tick(uint16_t Gates)
+{
+	const uint32_t Now     = gGlobalSysTickCounter;
+	const uint16_t Paused  = ~Gates & ((1u << TIMER_COUNT) - 1u);
+	const uint16_t Changed = Paused ^ gTimerPaused;
+
+	if (Changed) {
+		// freeze the time left on the ones that stop counting, pick it up again when they restart
+		for (unsigned int i = 0; i < TIMER_COUNT; i++) {
+			if (Changed & (1u << i))
+				gTimerValue[i] += (Paused & (1u << i)) ? -Now : Now;
+		}
+		gTimerPaused = Paused;
+		TIMER_UpdateNext();
+	}
+
+	if (!gTimerNextValid || (int32_t)(Now - gTimerNext) < 0)
+		return;
+
+	for (unsigned int i = 0; i < TIMER_COUNT; i++) {
+		const uint16_t Bit = 1u << i;
+		if ((gTimerRunning & ~gTimerPaused & Bit) && (int32_t)(Now - gTimerValue[i]) >= 0) {
+			gTimerRunning &= ~Bit;
+			if (gTimerFlags[i])
+				*gTimerFlags[i] = true;
+		}
+	}
+
+	TIMER_UpdateNext();
+}
+
+// starting a timer with 0 ticks stops it without raising the flag
+void TIMER_Start(TIMER_Id_t Id, uint32_t Ticks_10ms)
+{
+	const uint32_t Primask = __get_PRIMASK();
+	const uint16_t Bit     = 1u << Id;
+
+	__disable_irq();
+
+	if (Ticks_10ms == 0) {
+		gTimerRunning &= ~Bit;
+	} else {
+		gTimerValue[Id] = (gTimerPaused & Bit) ? Ticks_10ms : gGlobalSysTickCounter + Ticks_10ms;
+		gTimerRunning  |= Bit;
+	}
+
+	TIMER_UpdateNext();
+
+	__set_PRIMASK(Primask);
+}
+
+void TIMER_Stop(TIMER_Id_t Id)
+{
+	TIMER_Start(Id, 0);
+}
+
+bool TIMER_IsRunning(TIMER_Id_t Id)
+{
+	return (gTimerRunning & (1u << Id)) != 0;
+}
+
+uint32_t TIMER_Remaining(TIMER_Id_t Id)
+{
+	const uint32_t Primask = __get_PRIMASK();
+	uint32_t       Remaining = 0;
+
+	__disable_irq();
+
+	if (gTimerRunning & (1u << Id))
+		Remaining = (gTimerPaused & (1u << Id)) ? gTimerValue[Id] : gTimerValue[Id] - gGlobalSysTickCounter;
+
+	__set_PRIMASK(Primask);
+
+	return Remaining;
+}
+
+// ticks until the next timer runs out, TIMER_NO_DEADLINE if none is counting
+uint32_t TIMER_NextDeadline(void)
+{
+	const uint32_t Primask = __get_PRIMASK();
+	uint32_t       Ticks   = TIMER_NO_DEADLINE;
+
+	__disable_irq();
+
+	if (gTimerNextValid)
+		Ticks = gTimerNext - gGlobalSysTickCounter;
+
+	__set_PRIMASK(Primask);
+
+	return Ticks;
+}
 
 void SystickHandler(void);
 
-// we come here every 10ms
-void SystickHandler(void)
+static void SchedulerTick(void)
 {
 	gGlobalSysTickCounter++;
 	
 	gNextTimeslice = true;
 
+	BOARD_ADC_Service(gCurrentFunction != FUNCTION_TRANSMIT);
+
 	if ((gGlobalSysTickCounter % 50) == 0) {
 		gNextTimeslice_500ms = true;
 		
 		DECREMENT_AND_TRIGGER(gTxTimerCountdown_500ms, gTxTimeoutReached);
-		DECREMENT(gSerialConfigCountDown_500ms);
+		DECREMENT_AND_TRIGGER(gSerialConfigCountDown_500ms, gSerialBaudFallback);   // session over, back to 38400
 	}
 
 	if ((gGlobalSysTickCounter & 3) == 0)
@@ -67,46 +203,51 @@ void SystickHandler(void)
 	DECREMENT(gNOAACountdown_10ms);
 #endif
 
+	DECREMENT_AND_TRIGGER(gSerialBaudCountdown_10ms, gSerialBaudFallback);
+
 	DECREMENT(gFoundCDCSSCountdown_10ms);
 
 	DECREMENT(gFoundCTCSSCountdown_10ms);
 
+	uint16_t Gates = 1u << TIMER_TAIL_TONE | 1u << TIMER_VOICE | 1u << TIMER_VOX_STOP;
+
 	if (gCurrentFunction == FUNCTION_FOREGROUND)
-		DECREMENT_AND_TRIGGER(gBatterySaveCountdown_10ms, gSchedulePowerSave);
+		Gates |= 1u << TIMER_BATTERY_SAVE;
 
 	if (gCurrentFunction == FUNCTION_POWER_SAVE)
-		DECREMENT_AND_TRIGGER(gPowerSave_10ms, gPowerSaveCountdownExpired);
+		Gates |= 1u << TIMER_POWER_SAVE;
 
 	if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
 		if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE)
-			DECREMENT_AND_TRIGGER(gDualWatchCountdown_10ms, gScheduleDualWatch);
+			Gates |= 1u << TIMER_DUAL_WATCH;
 
 #ifdef ENABLE_NOAA
 	if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH == DUAL_WATCH_OFF)
 		if (gIsNoaaMode && gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
 			if (gCurrentFunction != FUNCTION_RECEIVE)
-				DECREMENT_AND_TRIGGER(gNOAA_Countdown_10ms, gScheduleNOAA);
+				Gates |= 1u << TIMER_NOAA;
 #endif
 
 	if (gScanStateDir != SCAN_OFF)
 		if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
-			DECREMENT_AND_TRIGGER(gScanPauseDelayIn_10ms, gScheduleScanListen);
-
-	DECREMENT_AND_TRIGGER(gTailToneEliminationCountdown_10ms, gFlagTailToneEliminationComplete);
-
-#ifdef ENABLE_VOICE
-	DECREMENT_AND_TRIGGER(gCountdownToPlayNextVoice_10ms, gFlagPlayQueuedVoice);
-#endif
+			Gates |= 1u << TIMER_SCAN_PAUSE;
 
 #ifdef ENABLE_FMRADIO
 	if (gFM_ScanState != FM_SCAN_OFF && gCurrentFunction != FUNCTION_MONITOR)
 		if (gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE)
-			DECREMENT_AND_TRIGGER(gFmPlayCountdown_10ms, gScheduleFM);
+			Gates |= 1u << TIMER_FM_PLAY;
 #endif
 
-#ifdef ENABLE_VOX
-	DECREMENT(gVoxStopCountdown_10ms);
-#endif
+	TIMER_Tick(Gates);
 
 	DECREMENT(boot_counter_10ms);
 }
+
+// we come here every 10ms, or every few 10ms in power save
+void SystickHandler(void)
+{
+	for (unsigned int i = SYSTICK_TakeTicks(); i > 0; i--)
+		SchedulerTick();
+
+	SYSTICK_PlanNext(TIMER_NextDeadline());
+}
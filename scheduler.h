@@ -0,0 +1,45 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 10ms countdowns run by the systick, each one raises its flag when it runs out
+typedef enum {
+	TIMER_BATTERY_SAVE,     // gSchedulePowerSave, counts in FUNCTION_FOREGROUND only
+	TIMER_POWER_SAVE,       // gPowerSaveCountdownExpired, counts in FUNCTION_POWER_SAVE only
+	TIMER_DUAL_WATCH,       // gScheduleDualWatch
+	TIMER_NOAA,             // gScheduleNOAA
+	TIMER_SCAN_PAUSE,       // gScheduleScanListen
+	TIMER_TAIL_TONE,        // gFlagTailToneEliminationComplete
+	TIMER_VOICE,            // gFlagPlayQueuedVoice
+	TIMER_FM_PLAY,          // gScheduleFM
+	TIMER_VOX_STOP,         // no flag, polled with TIMER_IsRunning()
+	TIMER_COUNT
+} TIMER_Id_t;
+
+#define TIMER_NO_DEADLINE 0xFFFFFFFFU
+
+void     TIMER_Start(TIMER_Id_t Id, uint32_t Ticks_10ms);
+void     TIMER_Stop(TIMER_Id_t Id);
+bool     TIMER_IsRunning(TIMER_Id_t Id);
+uint32_t TIMER_Remaining(TIMER_Id_t Id);
+uint32_t TIMER_NextDeadline(void);
+
+#endif
@@ -413,7 +413,7 @@ void SETTINGS_FactoryReset(bool bIsAll)
 		if (
 			!(i >= 0x0EE0 && i < 0x0F18) &&         // ANI ID + DTMF codes
 			!(i >= 0x0F30 && i < 0x0F50) &&         // AES KEY + F LOCK + Scramble Enable
-			!(i >= 0x1C00 && i < 0x1E00) &&         // DTMF contacts
+			!(i >= 0x1C00 && i < 0x1E00) &&         // DTMF contacts + spectrum blacklist
 			!(i >= 0x0EB0 && i < 0x0ED0) &&         // Welcome strings
 			!(i >= 0x0EA0 && i < 0x0EA8) &&         // Voice Prompt
 			(bIsAll ||
@@ -468,8 +468,7 @@ void SETTINGS_SaveFM(void)
 		//fmCfg.space    = gEeprom.FM_Space;
 		EEPROM_WriteBuffer(0x0E88, fmCfg.__raw);
 
-		for (unsigned i = 0; i < 5; i++)
-			EEPROM_WriteBuffer(0x0E40 + (i * 8), &gFM_Channels[i * 4]);
+		EEPROM_WriteRange(0x0E40, gFM_Channels, 5 * 8);
 	}
 #endif
 
@@ -658,31 +657,35 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 
 	if (Mode >= 2 || IS_FREQ_CHANNEL(Channel)) { // copy VFO to a channel
 		union {
-			uint8_t _8[8];
-			uint32_t _32[2];
+			uint8_t _8[16];
+			uint32_t _32[4];
 		} State;
 
 		State._32[0] = pVFO->freq_config_RX.Frequency;
 		State._32[1] = pVFO->TX_OFFSET_FREQUENCY;
-		EEPROM_WriteBuffer(OffsetVFO + 0, State._32);
 
-		State._8[0] =  pVFO->freq_config_RX.Code;
-		State._8[1] =  pVFO->freq_config_TX.Code;
-		State._8[2] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
-		State._8[3] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
-		State._8[4] = 0
+		State._8[8]  =  pVFO->freq_config_RX.Code;
+		State._8[9]  =  pVFO->freq_config_TX.Code;
+		State._8[10] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
+		State._8[11] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
+		State._8[12] = 0
 			| (pVFO->BUSY_CHANNEL_LOCK << 4)
 			| (pVFO->OUTPUT_POWER      << 2)
 			| (pVFO->CHANNEL_BANDWIDTH << 1)
 			| (pVFO->FrequencyReverse  << 0);
-		State._8[5] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
+		State._8[13] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
 #ifdef ENABLE_DTMF_CALLING
 			| ((pVFO->DTMF_DECODING_ENABLE & 1u) << 0)
 #endif
 		;
-		State._8[6] =  pVFO->STEP_SETTING;
-		State._8[7] =  pVFO->SCRAMBLING_TYPE;
-		EEPROM_WriteBuffer(OffsetVFO + 8, State._8);
+		State._8[14] =  pVFO->STEP_SETTING;
+		State._8[15] =  pVFO->SCRAMBLING_TYPE;
+		// the VFOs change with every tuning step and are written back later,
+		// a memory channel is saved on purpose and goes in right away
+		if (IS_MR_CHANNEL(Channel))
+			EEPROM_WriteThrough(OffsetVFO, State._8, sizeof(State._8));
+		else
+			EEPROM_WriteRange(OffsetVFO, State._8, sizeof(State._8));
 
 		SETTINGS_UpdateChannel(Channel, pVFO, true);
 
@@ -703,11 +706,11 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 void SETTINGS_SaveBatteryCalibration(const uint16_t * batteryCalibration)
 {
 	uint16_t buf[4];
-	EEPROM_WriteBuffer(0x1F40, batteryCalibration);
+	EEPROM_WriteThrough(0x1F40, batteryCalibration, 8);
 	EEPROM_ReadBuffer( 0x1F48, buf, sizeof(buf));
 	buf[0] = batteryCalibration[4];
 	buf[1] = batteryCalibration[5];
-	EEPROM_WriteBuffer(0x1F48, buf);
+	EEPROM_WriteThrough(0x1F48, buf, 8);
 }
 
 void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
@@ -715,8 +718,7 @@ void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
 	uint16_t offset = channel * 16;
 	uint8_t buf[16] = {0};
 	memcpy(buf, name, MIN(strlen(name), 10u));
-	EEPROM_WriteBuffer(0x0F50 + offset, buf);
-	EEPROM_WriteBuffer(0x0F58 + offset, buf + 8);
+	EEPROM_WriteThrough(0x0F50 + offset, buf, sizeof(buf));
 }
 
 void SETTINGS_UpdateChannel(uint8_t channel, const VFO_Info_t *pVFO, bool keep)
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+
+# Decodes the spectrum sweeps a firmware built with ENABLE_SPECTRUM_STREAM
+# sends while the spectrum analyzer runs, one CSV line per sweep:
+#   seq,timestamp_ms,f_start_hz,step_hz,dbm0,dbm1,...   (empty for skipped bins)
+#
+# usage: spectrum-stream.py <serial port or capture file> [baud]
+#        spectrum-stream.py --selftest
+
+import struct
+import sys
+
+STREAM_ID = 0xEFAC
+MAX_BINS  = 128
+HEADER = struct.Struct('<HBBIII')   # ID, Count, Seq, Timestamp, FStart, Step
+
+def crc16_xmodem(data, crc=0):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+def frames(read):
+    buf = b''
+    while True:
+        chunk = read(256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(struct.pack('<H', STREAM_ID))
+            if start < 0:
+                buf = buf[-1:]
+                break
+            buf = buf[start:]
+            if len(buf) < HEADER.size:
+                break
+            _, count, seq, timestamp, fstart, step = HEADER.unpack_from(buf)
+            if not 0 < count <= MAX_BINS:
+                buf = buf[2:]   # not a frame after all, look for the next ID
+                continue
+            size = HEADER.size + count + 2
+            if len(buf) < size:
+                break
+            body = buf[:HEADER.size + count]
+            crc, = struct.unpack_from('<H', buf, HEADER.size + count)
+            if crc16_xmodem(body) != crc:
+                buf = buf[2:]
+                continue
+            buf = buf[size:]
+            dbm = [None if b == 0xFF else b - 160 for b in body[HEADER.size:]]
+            yield seq, timestamp * 10, fstart * 10, step * 10, dbm
+
+def open_input(path, baud):
+    try:
+        import serial
+        port = serial.Serial(path, baud)
+        return lambda size: port.read(max(1, min(size, port.in_waiting)))
+    except (ImportError, ValueError, OSError):
+        return open(path, 'rb').read
+
+def encode(seq, ms, fstart, step, dbm):
+    body = HEADER.pack(STREAM_ID, len(dbm), seq, ms // 10, fstart // 10, step // 10)
+    body += bytes(0xFF if d is None else d + 160 for d in dbm)
+    return body + struct.pack('<H', crc16_xmodem(body))
+
+def chunked(data, size):
+    pos = 0
+    def read(_):
+        nonlocal pos
+        chunk = data[pos:pos + size]
+        pos += len(chunk)
+        return chunk
+    return read
+
+def selftest():
+    a = (7, 12340, 433000000, 12500, [-120, None, -60, -95])
+    b = (8, 12500, 433000000, 12500, [-121] * MAX_BINS)
+    bad_crc = bytearray(encode(*a))
+    bad_crc[-1] ^= 0x55
+    bogus_count = struct.pack('<HB', STREAM_ID, MAX_BINS + 1)
+    cases = [
+        ('two frames',          encode(*a) + encode(*b),                      [a, b]),
+        ('bad crc dropped',     bytes(bad_crc) + encode(*b),                  [b]),
+        ('garbage before',      b'\x00\xAC\x55' + encode(*a),                 [a]),
+        ('bogus count skipped', bogus_count + encode(*a),                     [a]),
+        ('zero count skipped',  struct.pack('<HB', STREAM_ID, 0) + encode(*b), [b]),
+        ('cut off at the end',  encode(*a) + encode(*b)[:-3],                 [a]),
+    ]
+    ok = True
+    for name, data, expected in cases:
+        for size in (1, 7, 256):
+            got = list(frames(chunked(data, size)))
+            if got != expected:
+                print('FAIL: %s, %d byte reads: got %r' % (name, size, got))
+                ok = False
+    if crc16_xmodem(b'123456789') != 0x31C3:
+        print('FAIL: crc16_xmodem check value')
+        ok = False
+    print('OK: spectrum-stream.py self test' if ok else 'FAIL: spectrum-stream.py self test')
+    return ok
+
+def main(argv):
+    if argv[:1] == ['--selftest']:
+        sys.exit(0 if selftest() else 1)
+    if not argv:
+        sys.exit('usage: spectrum-stream.py <serial port or capture file> [baud] | --selftest')
+
+    read = open_input(argv[0], int(argv[1]) if len(argv) > 1 else 38400)
+
+    for seq, ms, fstart, step, dbm in frames(read):
+        line = [seq, ms, fstart, step] + ['' if d is None else d for d in dbm]
+        print(','.join(map(str, line)), flush=True)
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,144 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// The UART side of the radio over stdin/stdout, in real time: bytes move
+// at the current baud rate, the RX DMA ring is read once per 10ms tick,
+// EEPROM page writes take 5ms with the ring filling meanwhile. At the end
+// of stdin the EEPROM image is written back to its file.
+//
+// usage: sim_radio <eeprom image> [drop every Nth byte]
+// exits with 1 when the RX ring ever overran
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tests/uart_host.h"
+
+#define PAGE_WRITE_US  5000U
+
+static unsigned int gDropEvery;
+static unsigned int gDropCount;
+static unsigned int gBitCredit;    // bit times owed to the line, keeps the rate exact
+static bool         gStdinClosed;
+
+// drops one byte every gDropEvery, in both directions
+static unsigned int Drop(uint8_t *pData, unsigned int Size)
+{
+	unsigned int Kept = 0;
+
+	for (unsigned int i = 0; i < Size; i++)
+		if (gDropEvery == 0 || ++gDropCount % gDropEvery != 0)
+			pData[Kept++] = pData[i];
+
+	return Kept;
+}
+
+// lets Us of line time pass, the TX ring only drains with interrupts on
+static void Advance(unsigned int Us, bool bTxDrains)
+{
+	const struct timespec Sleep = { 0, Us * 1000L };
+	uint8_t      Buffer[512];
+	unsigned int Budget;
+	unsigned int Bytes;
+
+	gBitCredit += (unsigned long long)gHostBaudRate * Us / 1000000U;
+	Budget      = gBitCredit / 10;
+	gBitCredit %= 10;
+
+	Bytes = Budget;
+	while (Bytes > 0 && !gStdinClosed) {
+		const ssize_t Read = read(STDIN_FILENO, Buffer, (Bytes < sizeof(Buffer)) ? Bytes : sizeof(Buffer));
+		if (Read == 0)
+			gStdinClosed = true;
+		if (Read <= 0)
+			break;
+		Bytes -= Read;
+		HOST_RxWrite(Buffer, Drop(Buffer, Read));
+	}
+
+	if (bTxDrains) {
+		unsigned int Size = gHostTxLength - gHostTxSent;
+
+		if (Size > Budget)
+			Size = Budget;
+		if (Size > sizeof(Buffer))
+			Size = sizeof(Buffer);
+
+		memcpy(Buffer, &gHostTx[gHostTxSent], Size);
+		gHostTxSent += Size;
+		if (gHostTxSent == gHostTxLength)
+			gHostTxLength = gHostTxSent = 0;
+
+		Size = Drop(Buffer, Size);
+		if (Size > 0 && write(STDOUT_FILENO, Buffer, Size) != (ssize_t)Size)
+			exit(2);
+	}
+
+	nanosleep(&Sleep, NULL);
+}
+
+static void OnEepromWrite(uint16_t Address, uint16_t Size)
+{
+	const unsigned int Pages = (Address % 32U + Size + 31U) / 32U;
+
+	// the commands run with interrupts off, only the RX DMA keeps going
+	Advance(Pages * PAGE_WRITE_US, false);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int Ticks = 0;
+	FILE        *pFile;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <eeprom image> [drop every Nth byte]\n", argv[0]);
+		return 2;
+	}
+
+	if (argc > 2)
+		gDropEvery = atoi(argv[2]);
+
+	pFile = fopen(argv[1], "rb");
+	if (pFile != NULL) {
+		if (fread(gHostEeprom, 1, sizeof(gHostEeprom), pFile) != sizeof(gHostEeprom))
+			memset(gHostEeprom, 0xFF, sizeof(gHostEeprom));
+		fclose(pFile);
+	}
+
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+	gHostOnEepromWrite = OnEepromWrite;
+
+	while (!gStdinClosed || gHostTxSent != gHostTxLength) {
+		Advance(10000, true);
+		HOST_SysTick();
+		HOST_Tick();
+		Ticks++;
+	}
+
+	pFile = fopen(argv[1], "wb");
+	if (pFile == NULL || fwrite(gHostEeprom, 1, sizeof(gHostEeprom), pFile) != sizeof(gHostEeprom))
+		return 2;
+	fclose(pFile);
+
+	fprintf(stderr, "sim_radio: %u ticks, %u bytes dropped, %u RX ring overruns\n",
+		Ticks, gDropEvery ? gDropCount / gDropEvery : 0, gHostRxOverrun);
+
+	return (gHostRxOverrun != 0) ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// Builds spectrum stream frames with the firmware's app/stream.c, writes
+// them to a capture file the way they leave the UART, with noise between
+// them and one frame that gets corrupted, and prints the sweeps the decoder
+// should find in spectrum-stream.py's CSV format.
+//
+// usage: stream_frames <capture file>
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "app/stream.h"
+
+#define SKIP 1000   // a bin the sweep skipped
+
+typedef struct {
+	uint8_t   Seq;
+	uint32_t  Timestamp;
+	uint32_t  FStart;
+	uint32_t  Step;
+	uint8_t   Count;
+	int       dBm[4];   // repeated over Count bins
+	bool      bCorrupt;
+} Sweep_t;
+
+static const Sweep_t gSweeps[] = {
+	{   7,       1234, 43300000,   1250,   4, { -120, SKIP,  -60,  -95 }, false },
+	{   8,       1250, 43300000,   1250, 128, { -121, -200,   94,  120 }, false },
+	{   9,       1266, 43300000,   1250, 128, {  -50,  -50,  -50,  -50 }, true  },
+	{ 255, 0xFFFFFFFF, 130000000, 100000,  1, { -160, SKIP, SKIP, SKIP }, false },
+};
+
+// what the decoder should give back for a bin, dBm clipped to what a byte holds
+static void PrintBin(int dBm)
+{
+	if (dBm == SKIP)
+		printf(",");
+	else
+		printf(",%d", dBm < -160 ? -160 : dBm > 94 ? 94 : dBm);
+}
+
+int main(int argc, char *argv[])
+{
+	// noise with the ID's low byte and a whole ID with a count that can't be
+	static const uint8_t Noise[] = { 0x00, 0xAC, 0x55, 0xAC, 0xEF, 0xC8, 0x13 };
+	uint8_t              Frame[STREAM_FRAME_SIZE(STREAM_MAX_BINS)];
+	FILE                *pFile;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <capture file>\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(argv[1], "wb");
+	if (!pFile) {
+		perror(argv[1]);
+		return 2;
+	}
+
+	for (unsigned int i = 0; i < sizeof(gSweeps) / sizeof(gSweeps[0]); i++) {
+		const Sweep_t  *pSweep = &gSweeps[i];
+		StreamHeader_t  Header;
+		uint16_t        Size;
+
+		Header.ID        = STREAM_ID;
+		Header.Count     = pSweep->Count;
+		Header.Seq       = pSweep->Seq;
+		Header.Timestamp = pSweep->Timestamp;
+		Header.FStart    = pSweep->FStart;
+		Header.Step      = pSweep->Step;
+
+		for (unsigned int j = 0; j < pSweep->Count; j++) {
+			const int dBm = pSweep->dBm[j % 4];
+			Frame[sizeof(Header) + j] = dBm == SKIP ? STREAM_SKIPPED : StreamEncodeDBm(dBm);
+		}
+
+		Size = StreamBuildFrame(Frame, &Header);
+		if (Size != STREAM_FRAME_SIZE(pSweep->Count)) {
+			fprintf(stderr, "FAIL frame %u is %u bytes\n", i, Size);
+			return 1;
+		}
+
+		if (pSweep->bCorrupt)
+			Frame[sizeof(Header) + 5] ^= 0x01;
+
+		fwrite(Noise, 1, sizeof(Noise), pFile);
+		fwrite(Frame, 1, Size, pFile);
+
+		if (pSweep->bCorrupt)
+			continue;
+
+		printf("%u,%llu,%llu,%llu", pSweep->Seq, pSweep->Timestamp * 10ULL, pSweep->FStart * 10ULL, pSweep->Step * 10ULL);
+		for (unsigned int j = 0; j < pSweep->Count; j++)
+			PrintBin(pSweep->dBm[j % 4]);
+		printf("\n");
+	}
+
+	fclose(pFile);
+
+	return 0;
+}
@@ -0,0 +1,41 @@
+/* Host stand-ins for the CMSIS core functions the firmware sources use,
+ * so they can be compiled into the tests with the host compiler.
+ */
+
+#ifndef TESTS_STUB_ARMCM0_H
+#define TESTS_STUB_ARMCM0_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t __get_PRIMASK(void)
+{
+	return 0;
+}
+
+static inline void __set_PRIMASK(uint32_t Primask)
+{
+	(void)Primask;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __enable_irq(void)
+{
+}
+
+typedef int IRQn_Type;
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	(void)IRQn;
+}
+
+static inline void NVIC_SystemReset(void)
+{
+	abort();
+}
+
+#endif
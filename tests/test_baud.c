@@ -0,0 +1,85 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// UART_GetBaudDivisor() over the whole range of the RC trim register: the
+// 38400 divisor has to stay what the stock firmware computed, the other
+// rates have to be the nearest divisor to the same trimmed clock.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "bsp/dp32g030/syscon.h"
+#include "driver/uart.h"
+
+static unsigned int gFailures;
+
+void _putchar(char c)
+{
+	(void)c;
+}
+
+static uint32_t RcFreqDelta(bool bPositive, uint32_t Delta)
+{
+	return (bPositive ? SYSCON_RC_FREQ_DELTA_RCHF_SIG_MASK : 0)
+		| ((Delta << SYSCON_RC_FREQ_DELTA_RCHF_DELTA_SHIFT) & SYSCON_RC_FREQ_DELTA_RCHF_DELTA_MASK)
+		| 0x5A5U;   // RCLF trim bits, must not matter
+}
+
+static void CheckRates(bool bPositive, uint32_t Delta)
+{
+	static const uint32_t Rates[] = { 57600, UART_BAUD_MAX };
+	const uint32_t Register  = RcFreqDelta(bPositive, Delta);
+	const uint32_t Frequency = bPositive ? 48000000U + Delta : 48000000U - Delta;
+
+	// what the stock UART_Init() wrote
+	if (UART_GetBaudDivisor(Register, UART_BAUD_DEFAULT) != Frequency / 39053U) {
+		printf("FAIL 38400 at %uHz: %u, stock %u\n", Frequency, UART_GetBaudDivisor(Register, UART_BAUD_DEFAULT), Frequency / 39053U);
+		gFailures++;
+	}
+
+	for (unsigned int i = 0; i < sizeof(Rates) / sizeof(Rates[0]); i++) {
+		const uint32_t Divisor = UART_GetBaudDivisor(Register, Rates[i]);
+		const double   Ideal   = Frequency / (Rates[i] * 39053.0 / 38400.0);
+
+		if (fabs(Divisor - Ideal) > 0.51) {
+			printf("FAIL %u at %uHz: %u, ideal %.2f\n", Rates[i], Frequency, Divisor, Ideal);
+			gFailures++;
+		}
+	}
+}
+
+int main(void)
+{
+	// every trim the 20 bit field can hold would take a while, the low
+	// end in full and the rest in steps that hit all the rounding phases
+	for (uint32_t Delta = 0; Delta < 0x100000U; Delta += (Delta < 200000U) ? 1 : 997) {
+		CheckRates(true, Delta);
+		CheckRates(false, Delta);
+	}
+
+	printf("divisors at 48MHz: 38400 -> %u, 57600 -> %u, 115200 -> %u\n",
+		UART_GetBaudDivisor(RcFreqDelta(true, 0), UART_BAUD_DEFAULT),
+		UART_GetBaudDivisor(RcFreqDelta(true, 0), 57600),
+		UART_GetBaudDivisor(RcFreqDelta(true, 0), UART_BAUD_MAX));
+
+	if (gFailures) {
+		printf("%u divisors wrong\n", gFailures);
+		return 1;
+	}
+
+	printf("baud divisors OK\n");
+	return 0;
+}
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# Loopback test of eeprom-bulk.py against app/uart.c running in sim_radio:
+# writes an image, reads it back and checks both against the simulated
+# EEPROM, on a clean link and on one that drops bytes.
+#
+# usage: test_bulk.py <sim_radio binary>
+
+import importlib.util
+import os
+import random
+import select
+import subprocess
+import sys
+import tempfile
+import time
+
+here = os.path.dirname(os.path.abspath(__file__))
+spec = importlib.util.spec_from_file_location('eeprom_bulk', os.path.join(here, '..', 'eeprom-bulk.py'))
+eeprom_bulk = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(eeprom_bulk)
+
+class PipeLink:
+    def __init__(self, args):
+        self.sim = subprocess.Popen(args, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+    def read(self, size):
+        ready, _, _ = select.select([self.sim.stdout], [], [], 0.05)
+        return os.read(self.sim.stdout.fileno(), size) if ready else b''
+
+    def write(self, data):
+        self.sim.stdin.write(data)
+        self.sim.stdin.flush()
+
+    def set_baud(self, baud):
+        pass    # the simulator paces itself by the rate the radio is set to
+
+    def close(self):
+        self.sim.stdin.close()
+        self.sim.stdout.close()
+        stderr = self.sim.stderr.read().decode()
+        return self.sim.wait(), stderr
+
+def run(sim, baud, drop, offset, length):
+    rng = random.Random(baud * 1000 + drop)
+    before = bytes(rng.getrandbits(8) for _ in range(eeprom_bulk.EEPROM_SIZE))
+    data = bytes(rng.getrandbits(8) for _ in range(length))
+    expected = before[:offset] + data + before[offset + length:]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        image = os.path.join(tmp, 'eeprom.bin')
+        open(image, 'wb').write(before)
+
+        link = PipeLink([sim, image, str(drop)])
+        radio = eeprom_bulk.Radio(link)
+        radio.hello()
+        if baud != 38400:
+            radio.set_baud(baud)
+        started = time.monotonic()
+        radio.write(offset, data)
+        written = time.monotonic()
+        readback = radio.read(0, eeprom_bulk.EEPROM_SIZE)
+        done = time.monotonic()
+        status, stderr = link.close()
+
+        after = open(image, 'rb').read()
+
+    sys.stderr.write(stderr)
+    print('  write %.0f bytes/s, read %.0f bytes/s' % (length / (written - started), len(readback) / (done - written)))
+    ok = status == 0 and after == expected and readback == expected
+    print('%s: %d baud, drop every %s byte: %s' % ('OK' if ok else 'FAIL', baud, drop or 'no', 'transfers match' if ok else 'status %d, eeprom %s, read back %s' % (status, after == expected, readback == expected)))
+    return ok
+
+# ranges past the end of the EEPROM get a NAK instead of an ack or silence
+def rejected(sim):
+    before = bytes(range(256)) * (eeprom_bulk.EEPROM_SIZE // 256)
+    errors = []
+
+    with tempfile.TemporaryDirectory() as tmp:
+        image = os.path.join(tmp, 'eeprom.bin')
+        open(image, 'wb').write(before)
+
+        link = PipeLink([sim, image, '0'])
+        radio = eeprom_bulk.Radio(link)
+        radio.hello()
+        for action in (lambda: radio.write(0x1FF8, bytes(16)), lambda: radio.read(0x1FF8, 16)):
+            try:
+                action()
+            except IOError as e:
+                errors.append(str(e))
+        status, stderr = link.close()
+
+        after = open(image, 'rb').read()
+
+    sys.stderr.write(stderr)
+    ok = status == 0 and after == before and len(errors) == 2 and all('rejected' in e for e in errors)
+    print('%s: past the end rejected: %s' % ('OK' if ok else 'FAIL', '; '.join(errors) or 'no errors'))
+    return ok
+
+def main():
+    sim = sys.argv[1]
+    results = [
+        run(sim, 38400, 0, 0x0400, 0x0400),
+        run(sim, 115200, 0, 0x0000, 0x2000),
+        run(sim, 115200, 997, 0x1000, 0x0800),
+        rejected(sim),
+    ]
+    sys.exit(0 if all(results) else 1)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,126 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// SYSTICK_DelayNs() turns the bit-bang edge times into SUBS/BNE loop counts
+// at compile time. Checks the count against a cycle model of the loop built
+// here from the Cortex-M0 instruction timings: it must be the fewest loops
+// that last the time asked for. Then models the BK4819 and EEPROM
+// transactions with the stock SYSTICK_DelayUs(1) edges and with the loop
+// delays, see the constants below for what the model leaves out.
+
+#include <stdio.h>
+
+#include "driver/systick.h"
+
+#define CORE_MHZ 48U
+
+// MOVS for the count, n SUBS, n - 1 taken BNE at 3 cycles, the last one at 1
+static unsigned int LoopCycles(unsigned int Loops)
+{
+	return 1U + Loops + (Loops - 1U) * 3U + 1U;
+}
+
+// SYSTICK_DelayUs(1) waits until SysTick moved 48 counts, then there is the
+// call, the LOAD/VAL reads before it starts, the VAL poll granularity and
+// the return. About 30 cycles all in, an estimate from the code, not a
+// measurement
+#define DELAY_US_CYCLES (CORE_MHZ + 30U)
+
+// a GPIO set/clear is a load, an OR/BIC and a store on the port register,
+// the same before and after so it doesn't move the ratio much
+#define GPIO_CYCLES 4U
+
+static unsigned int gFailures;
+
+static void CheckDelay(unsigned int Ns)
+{
+	const unsigned int Loops = SYSTICK_NS_TO_LOOPS(Ns);
+	const unsigned int Want  = Ns * CORE_MHZ;   // cycles * 1000
+
+	if (Loops == 0 || LoopCycles(Loops) * 1000U < Want ||
+		(Loops > 1 && LoopCycles(Loops - 1) * 1000U >= Want) ||
+		SYSTICK_LOOPS_TO_CYCLES(Loops) != LoopCycles(Loops)) {
+		printf("FAIL %uns -> %u loops (%u cycles)\n", Ns, Loops, LoopCycles(Loops));
+		gFailures++;
+	}
+}
+
+static unsigned int Cycles(unsigned int Ns)
+{
+	return LoopCycles(SYSTICK_NS_TO_LOOPS(Ns));
+}
+
+typedef struct {
+	const char   *pName;
+	unsigned int  Gpio;      // port writes
+	unsigned int  Before;    // SYSTICK_DelayUs(1) calls in the stock driver
+	unsigned int  After;     // cycles spent in SYSTICK_DelayNs() now
+} Transaction_t;
+
+static void Report(const Transaction_t *pT)
+{
+	const unsigned int Before = pT->Gpio * GPIO_CYCLES + pT->Before * DELAY_US_CYCLES;
+	const unsigned int After  = pT->Gpio * GPIO_CYCLES + pT->After;
+
+	printf("  %-22s before %6u/s  after %6u/s  (x%u.%u)\n", pT->pName,
+		CORE_MHZ * 1000000U / Before, CORE_MHZ * 1000000U / After,
+		Before / After, Before * 10U / After % 10U);
+}
+
+int main(void)
+{
+	for (unsigned int Ns = 0; Ns <= 100000; Ns++)
+		CheckDelay(Ns);
+
+	// the edge times the drivers use, see driver/bk4819.c and driver/i2c.c
+	const unsigned int Spi = Cycles(250);   // BK4819 SCL high or low
+	const unsigned int Scn = Cycles(500);   // BK4819 SCN setup/hold
+	const unsigned int H   = Cycles(600);   // I2C SCL high
+	const unsigned int L   = Cycles(1900);  // I2C SCL low
+
+	// edge counts from the stock and the current drivers
+	const Transaction_t List[] = {
+		// SCN, 8 + 16 bits at 3 edges each, 3 more SCN waits / 2 + 24 bits now
+		{ "BK4819 register write", 80, 76, 3 * Scn + 24 * 2 * Spi },
+		// SCN, 8 bits out, turnaround, 16 bits in at 2 edges, SCN
+		{ "BK4819 register read",  83, 59, 2 * Scn + 8 * 2 * Spi + Spi + 16 * 2 * Spi },
+		// START, 2 address + device byte, repeated START, device byte, 8 bytes
+		// in, STOP. 28 stock delays per byte out, 36 per byte in, 4 per
+		// START/STOP / 9 bit times per byte, 4 high phases per START
+		{ "EEPROM 8 byte read",   424, 4 + 3 * 28 + 4 + 28 + 8 * 36 + 4, 8 * H + 12 * 9 * (H + L) + 2 * (H + L) },
+	};
+
+	const unsigned int I2cBit = (H + L) * 1000U / CORE_MHZ;
+
+	printf("BK4819 bit %uns (SCL <= %ukHz)\n", 2 * Spi * 1000U / CORE_MHZ, CORE_MHZ * 1000U / (2 * Spi));
+	printf("I2C bit %uns (SCL <= %ukHz)\n", I2cBit, 1000000U / I2cBit);
+	if (I2cBit < 2500) {
+		printf("FAIL I2C bit under 2.5us, faster than 400kHz\n");
+		gFailures++;
+	}
+
+	printf("transactions, stock SYSTICK_DelayUs(1) edges vs loop delays (model):\n");
+	for (unsigned int i = 0; i < sizeof(List) / sizeof(List[0]); i++)
+		Report(&List[i]);
+
+	if (gFailures) {
+		printf("%u delays out of range\n", gFailures);
+		return 1;
+	}
+
+	printf("delays OK\n");
+	return 0;
+}
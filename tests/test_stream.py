@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+
+# Feeds the spectrum stream frames app/stream.c builds (see stream_frames.c)
+# to spectrum-stream.py's decoder, in reads of a few sizes, and checks it
+# finds exactly the sweeps the firmware meant to send.
+#
+# usage: test_stream.py <stream_frames binary>
+
+import importlib.util
+import os
+import subprocess
+import sys
+import tempfile
+
+here = os.path.dirname(os.path.abspath(__file__))
+spec = importlib.util.spec_from_file_location('spectrum_stream', os.path.join(here, '..', 'spectrum-stream.py'))
+spectrum_stream = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(spectrum_stream)
+
+def csv(sweep):
+    seq, ms, fstart, step, dbm = sweep
+    return ','.join(map(str, [seq, ms, fstart, step] + ['' if d is None else d for d in dbm]))
+
+def main():
+    with tempfile.TemporaryDirectory() as tmp:
+        capture = os.path.join(tmp, 'stream.bin')
+        expected = subprocess.run([sys.argv[1], capture], stdout=subprocess.PIPE, check=True).stdout.decode().splitlines()
+        data = open(capture, 'rb').read()
+
+    ok = True
+    for size in (1, 7, 256):
+        got = [csv(sweep) for sweep in spectrum_stream.frames(spectrum_stream.chunked(data, size))]
+        if got != expected:
+            print('FAIL: %d byte reads: got %r, expected %r' % (size, got, expected))
+            ok = False
+    print('%s: %d firmware frames decoded' % ('OK' if ok else 'FAIL', len(expected)))
+    sys.exit(0 if ok else 1)
+
+if __name__ == '__main__':
+    main()
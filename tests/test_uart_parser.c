@@ -0,0 +1,263 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// Feeds frames through the RX ring into the incremental parser of
+// app/uart.c: split over many polls, across the ring wrap, mixed with
+// garbage and broken frames, obfuscated and plain, and "SMS:" lines.
+// Ends with a throughput figure for the parser on the host.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tests/uart_host.h"
+
+#define CHECK(x) do { if (!(x)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #x); gFailures++; } } while (0)
+
+static unsigned int gFailures;
+
+// a command with a recognisable payload, ID 0x0601 is never switched on here
+static unsigned int MakeFrame(uint8_t *pFrame, uint16_t ID, uint16_t Size, uint8_t Seed, bool bObfuscate)
+{
+	uint8_t Command[256];
+
+	Command[0] = ID & 0xFFU;
+	Command[1] = ID >> 8;
+	Command[2] = (Size - 4) & 0xFFU;
+	Command[3] = (Size - 4) >> 8;
+	for (unsigned int i = 4; i < Size; i++)
+		Command[i] = Seed + i;
+
+	return HOST_BuildFrame(pFrame, Command, Size, bObfuscate);
+}
+
+static bool IsFrame(uint16_t ID, uint16_t Size, uint8_t Seed)
+{
+	const uint8_t *pData = HOST_CommandData();
+
+	if (HOST_CommandID() != ID)
+		return false;
+
+	for (unsigned int i = 4; i < Size; i++)
+		if (pData[i] != (uint8_t)(Seed + i))
+			return false;
+
+	return true;
+}
+
+// every byte on its own poll, nothing may come out before the last one
+static void TestByteAtATime(void)
+{
+	uint8_t      Frame[256];
+	unsigned int Length = MakeFrame(Frame, 0x0601, 100, 7, true);
+	unsigned int Found  = 0;
+
+	for (unsigned int i = 0; i < Length; i++) {
+		HOST_RxWrite(&Frame[i], 1);
+		if (HOST_Poll()) {
+			CHECK(i == Length - 1);
+			CHECK(IsFrame(0x0601, 100, 7));
+			Found++;
+		}
+	}
+
+	CHECK(Found == 1);
+}
+
+// two frames in one DMA burst come out one per poll
+static void TestBackToBack(void)
+{
+	uint8_t      Frames[256];
+	unsigned int Length;
+
+	Length  = MakeFrame(Frames, 0x0601, 40, 1, true);
+	Length += MakeFrame(&Frames[Length], 0x0601, 60, 2, true);
+	HOST_RxWrite(Frames, Length);
+
+	CHECK(HOST_Poll() && IsFrame(0x0601, 40, 1));
+	CHECK(HOST_Poll() && IsFrame(0x0601, 60, 2));
+	CHECK(!HOST_Poll());
+}
+
+// the ring wraps every 256 bytes, walk a frame across every position of it
+static void TestRingWrap(void)
+{
+	uint8_t Frame[256];
+
+	for (unsigned int Shift = 0; Shift < 256; Shift++) {
+		const unsigned int Length = MakeFrame(Frame, 0x0601, 24 + Shift % 100, Shift, true);
+		HOST_RxWrite(Frame, Length);
+		CHECK(HOST_Poll() && IsFrame(0x0601, 24 + Shift % 100, Shift));
+		HOST_RxWrite("\x55", 1);
+		CHECK(!HOST_Poll());
+	}
+}
+
+// a broken frame is dropped and the parser picks up the one right behind it
+static void TestResync(void)
+{
+	static const uint8_t Garbage[] = { 0xAB, 0xAB, 0xCD, 0x02, 0xFF, 0xAB, 0x00, 0xDC, 0xBA, 0xCD };
+	uint8_t      Frame[256];
+	unsigned int Length;
+
+	// noise with false starts, and an 0xAB right before the real one
+	HOST_RxWrite(Garbage, 2);
+	HOST_RxWrite(&Garbage[5], 4);
+	HOST_RxWrite(&Garbage[0], 1);
+	Length = MakeFrame(Frame, 0x0601, 32, 3, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 32, 3));
+
+	// size too big for the ring, never waited for
+	HOST_RxWrite(Garbage, 5);
+	Length = MakeFrame(Frame, 0x0601, 32, 4, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 32, 4));
+
+	// bad CRC
+	Length = MakeFrame(Frame, 0x0601, 48, 5, true);
+	Frame[20] ^= 0x10;
+	HOST_RxWrite(Frame, Length);
+	Length = MakeFrame(Frame, 0x0601, 48, 6, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 48, 6));
+	CHECK(!HOST_Poll());
+
+	// bad footer
+	Length = MakeFrame(Frame, 0x0601, 16, 7, true);
+	Frame[Length - 1] = 0xBB;
+	HOST_RxWrite(Frame, Length);
+	CHECK(!HOST_Poll());
+	Length = MakeFrame(Frame, 0x0601, 16, 8, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 16, 8));
+
+	// a frame cut short swallows what follows up to its own length and
+	// fails its CRC, the frame after that gets through
+	static const uint8_t Zeros[64];
+	Length = MakeFrame(Frame, 0x0601, 64, 9, true);
+	HOST_RxWrite(Frame, 30);
+	Length = MakeFrame(Frame, 0x0601, 8, 10, true);
+	HOST_RxWrite(Frame, Length);
+	HOST_RxWrite(Zeros, sizeof(Zeros));
+	CHECK(!HOST_Poll());
+	Length = MakeFrame(Frame, 0x0601, 8, 11, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 8, 11));
+}
+
+// the raw ID of a hello turns the obfuscation off (0x0514) or on (0x6902),
+// once the frame's CRC matches
+static void TestObfuscationSwitch(void)
+{
+	uint8_t      Frame[256];
+	unsigned int Length;
+
+	// a corrupted plain hello leaves the obfuscation on
+	Length = MakeFrame(Frame, 0x0514, 8, 0, false);
+	Frame[8] ^= 0x01;
+	HOST_RxWrite(Frame, Length);
+	CHECK(!HOST_Poll());
+
+	Length = MakeFrame(Frame, 0x0601, 80, 10, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 80, 10));
+
+	Length = MakeFrame(Frame, 0x0514, 8, 0, false);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && HOST_CommandID() == 0x0514);
+
+	Length = MakeFrame(Frame, 0x0601, 80, 11, false);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 80, 11));
+
+	// an obfuscated 0x0514 starts with 0x6902 on the wire
+	Length = MakeFrame(Frame, 0x0514, 8, 0, true);
+	CHECK(Frame[4] == 0x02 && Frame[5] == 0x69);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && HOST_CommandID() == 0x0514);
+
+	Length = MakeFrame(Frame, 0x0601, 80, 12, true);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 80, 12));
+}
+
+#if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+static void TestTextLine(void)
+{
+	uint8_t      Frame[256];
+	unsigned int Length;
+
+	HOST_RxWrite("xSSMS:hello\r\n", 13);
+	CHECK(!HOST_Poll());
+	CHECK(strcmp(gHostTextLine, "hello") == 0);
+
+	// too long for a message, cut to fit
+	HOST_RxWrite("SMS:0123456789012345678901234567890123456789\n", 45);
+	CHECK(!HOST_Poll());
+	CHECK(strncmp(gHostTextLine, "0123456789", 10) == 0 && strlen(gHostTextLine) < 40);
+
+	// and frames still work around text
+	Length = MakeFrame(Frame, 0x0601, 20, 13, true);
+	HOST_RxWrite("SMS:a\n", 6);
+	HOST_RxWrite(Frame, Length);
+	CHECK(HOST_Poll() && IsFrame(0x0601, 20, 13));
+	CHECK(strcmp(gHostTextLine, "a") == 0);
+}
+#endif
+
+// big frames back to back, one poll per frame as in the main loop
+static void Benchmark(void)
+{
+	enum { FRAMES = 200000 };
+	uint8_t      Frame[256];
+	unsigned int Length = MakeFrame(Frame, 0x0601, 200, 14, true);
+	unsigned int Found  = 0;
+	clock_t      Start  = clock();
+
+	for (unsigned int i = 0; i < FRAMES; i++) {
+		HOST_RxWrite(Frame, Length);
+		Found += HOST_Poll();
+	}
+
+	const double Seconds = (double)(clock() - Start) / CLOCKS_PER_SEC;
+
+	CHECK(Found == FRAMES);
+	printf("parser: %.1f MB/s, %.1f ns per byte on this host\n",
+		FRAMES * (double)Length / Seconds / 1e6, Seconds * 1e9 / (FRAMES * (double)Length));
+}
+
+int main(void)
+{
+	TestByteAtATime();
+	TestBackToBack();
+	TestRingWrap();
+	TestResync();
+	TestObfuscationSwitch();
+#if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+	TestTextLine();
+#endif
+	Benchmark();
+	CHECK(gHostRxOverrun == 0);
+
+	if (gFailures) {
+		printf("%u checks failed\n", gFailures);
+		return 1;
+	}
+
+	printf("parser OK\n");
+	return 0;
+}
@@ -0,0 +1,289 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+// the RX DMA channel registers are a plain struct here, the ring index the
+// parser chases is ST, as on the chip
+#include "bsp/dp32g030/dma.h"
+
+static DMA_Channel_t gHostDmaCh0;
+
+#undef  DMA_CH0
+#define DMA_CH0  (&gHostDmaCh0)
+
+#include "app/uart.c"
+
+#include "tests/uart_host.h"
+
+// misc.h only has an inline definition, this makes it an external one
+extern bool SerialConfigInProgress();
+
+uint8_t      gHostEeprom[0x2000];
+uint8_t      gHostTx[HOST_TX_SIZE];
+unsigned int gHostTxLength;
+unsigned int gHostTxSent;
+void       (*gHostOnEepromWrite)(uint16_t Address, uint16_t Size);
+unsigned int gHostRxOverrun;
+uint32_t     gHostBaudRate = UART_BAUD_DEFAULT;
+char         gHostTextLine[64];
+
+uint8_t          UART_DMA_Buffer[256];
+EEPROM_Config_t  gEeprom;
+FUNCTION_Type_t  gCurrentFunction;
+
+static unsigned int gHostRxUnread;
+
+void HOST_RxWrite(const void *pData, unsigned int Size)
+{
+	const uint8_t *pBytes = (const uint8_t *)pData;
+	uint16_t       Index  = DMA_CH0->ST & 0xFFFU;
+
+	for (; Size > 0; Size--) {
+		if (++gHostRxUnread > sizeof(UART_DMA_Buffer) - 1) {
+			// the DMA laps the parser, what it lost is gone
+			gHostRxOverrun++;
+			gHostRxUnread--;
+			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+		}
+		UART_DMA_Buffer[Index] = *pBytes++;
+		Index = DMA_INDEX(Index, 1);
+	}
+
+	DMA_CH0->ST = Index;
+}
+
+unsigned int HOST_RxFree(void)
+{
+	return sizeof(UART_DMA_Buffer) - 1 - gHostRxUnread;
+}
+
+bool HOST_Poll(void)
+{
+	const bool bAvailable = UART_IsCommandAvailable();
+
+	gHostRxUnread = (uint16_t)((DMA_CH0->ST & 0xFFFU) - gUART_WriteIndex) % sizeof(UART_DMA_Buffer);
+
+	return bAvailable;
+}
+
+uint16_t HOST_CommandID(void)
+{
+	return UART_Command.Header.ID;
+}
+
+const uint8_t *HOST_CommandData(void)
+{
+	return UART_Command.Buffer;
+}
+
+void HOST_SysTick(void)
+{
+	static unsigned int Ticks;
+
+	if ((++Ticks % 50) == 0)
+		if (gSerialConfigCountDown_500ms > 0 && --gSerialConfigCountDown_500ms == 0)
+			gSerialBaudFallback = true;
+
+	if (gSerialBaudCountdown_10ms > 0 && --gSerialBaudCountdown_10ms == 0)
+		gSerialBaudFallback = true;
+}
+
+void HOST_Tick(void)
+{
+	if (gSerialBaudFallback) {
+		gSerialBaudFallback = false;
+		UART_SetBaudRate(UART_BAUD_DEFAULT);
+	}
+
+	while (HOST_Poll())
+		UART_HandleCommand();
+
+	UART_ServiceBulkTransfer();
+}
+
+// bit at a time, so a broken table in driver/crc.c can't hide behind itself
+static uint16_t HOST_Crc16(const uint8_t *pData, unsigned int Size)
+{
+	uint16_t Crc = 0;
+
+	while (Size--) {
+		Crc ^= *pData++ << 8;
+		for (unsigned int i = 0; i < 8; i++)
+			Crc = (Crc & 0x8000U) ? (Crc << 1) ^ 0x1021U : (unsigned int)Crc << 1;
+	}
+
+	return Crc;
+}
+
+unsigned int HOST_BuildFrame(uint8_t *pFrame, const void *pCommand, uint16_t Size, bool bObfuscate)
+{
+	const uint16_t Crc = HOST_Crc16(pCommand, Size);
+	unsigned int   i;
+
+	pFrame[0] = 0xAB;
+	pFrame[1] = 0xCD;
+	pFrame[2] = Size & 0xFFU;
+	pFrame[3] = Size >> 8;
+	memcpy(&pFrame[4], pCommand, Size);
+	pFrame[4 + Size] = Crc & 0xFFU;
+	pFrame[5 + Size] = Crc >> 8;
+
+	if (bObfuscate)
+		for (i = 0; i < Size + 2u; i++)
+			pFrame[4 + i] ^= Obfuscation[i % 16];
+
+	pFrame[6 + Size] = 0xDC;
+	pFrame[7 + Size] = 0xBA;
+
+	return Size + 8u;
+}
+
+unsigned int HOST_NextReply(unsigned int *pOffset, uint8_t *pPayload)
+{
+	unsigned int Offset = *pOffset;
+
+	while (Offset + 8 <= gHostTxLength) {
+		const uint16_t Size = gHostTx[Offset + 2] | (gHostTx[Offset + 3] << 8);
+
+		if (gHostTx[Offset] != 0xAB || gHostTx[Offset + 1] != 0xCD || Offset + Size + 8 > gHostTxLength) {
+			Offset++;
+			continue;
+		}
+
+		memcpy(pPayload, &gHostTx[Offset + 4], Size);
+		if (bIsEncrypted)
+			for (unsigned int i = 0; i < Size; i++)
+				pPayload[i] ^= Obfuscation[i % 16];
+
+		*pOffset = Offset + Size + 8;
+		return Size;
+	}
+
+	*pOffset = Offset;
+	return 0;
+}
+
+void HOST_StartSession(uint32_t Timestamp)
+{
+	CMD_0514_t Cmd;
+	uint8_t    Frame[sizeof(Cmd) + 8];
+
+	Cmd.Header.ID   = 0x0514;
+	Cmd.Header.Size = sizeof(Cmd) - sizeof(Cmd.Header);
+	Cmd.Timestamp   = Timestamp;
+
+	HOST_RxWrite(Frame, HOST_BuildFrame(Frame, &Cmd, sizeof(Cmd), true));
+	while (HOST_Poll())
+		UART_HandleCommand();
+}
+
+// what app/uart.c needs from the rest of the firmware
+
+void _putchar(char c)
+{
+	(void)c;
+}
+
+void UART_Send(const void *pBuffer, uint32_t Size)
+{
+	if (gHostTxLength + Size > sizeof(gHostTx))
+		gHostTxLength = gHostTxSent = 0;
+	memcpy(&gHostTx[gHostTxLength], pBuffer, Size);
+	gHostTxLength += Size;
+}
+
+uint32_t UART_TxFree(void)
+{
+	const unsigned int Queued = gHostTxLength - gHostTxSent;
+
+	return (Queued < 255) ? 255 - Queued : 0;
+}
+
+void UART_WaitTxDone(void)
+{
+}
+
+void UART_SetBaudRate(uint32_t BaudRate)
+{
+	gHostBaudRate = BaudRate;
+}
+
+void UART_printf(const char *str, ...)
+{
+	(void)str;
+}
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+{
+	memcpy(pBuffer, &gHostEeprom[Address % sizeof(gHostEeprom)], Size);
+}
+
+void EEPROM_WriteRange(uint16_t Address, const void *pBuffer, uint16_t Size)
+{
+	if (Address >= sizeof(gHostEeprom) || Size > sizeof(gHostEeprom) - Address)
+		return;
+
+	memcpy(&gHostEeprom[Address], pBuffer, Size);
+
+	if (gHostOnEepromWrite != NULL)
+		gHostOnEepromWrite(Address, Size);
+}
+
+#if defined(ENABLE_MESSENGER) || defined(ENABLE_MESSENGER_UART)
+void MSG_Send(const char txMessage[TX_MSG_LENGTH], bool bServiceMessage)
+{
+	(void)bServiceMessage;
+	snprintf(gHostTextLine, sizeof(gHostTextLine), "%s", txMessage);
+}
+#endif
+
+void AES_Encrypt(const void *pKey, const void *pIv, const void *pIn, void *pOut, uint8_t NumBlocks)
+{
+	(void)pKey; (void)pIv; (void)pIn; (void)NumBlocks;
+	memset(pOut, 0, 16);
+}
+
+void BACKLIGHT_TurnOff()
+{
+}
+
+uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
+{
+	return Register;
+}
+
+void BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent)
+{
+	*pVoltage = 0;
+	*pCurrent = 0;
+}
+
+void SETTINGS_InitEEPROM(void)
+{
+}
+
+void FUNCTION_Select(FUNCTION_Type_t Function)
+{
+	gCurrentFunction = Function;
+}
+
+FREQUENCY_Band_t FREQUENCY_GetBand(uint32_t Frequency)
+{
+	(void)Frequency;
+	return BAND1_50MHz;
+}
@@ -0,0 +1,62 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef TESTS_UART_HOST_H
+#define TESTS_UART_HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// app/uart.c running on the host: the RX DMA ring is filled from here, the
+// replies land in gHostTx and the EEPROM is a plain array
+
+#define HOST_TX_SIZE  0x10000U
+
+extern uint8_t      gHostEeprom[0x2000];
+extern uint8_t      gHostTx[HOST_TX_SIZE];
+extern unsigned int gHostTxLength;
+extern unsigned int gHostTxSent;        // gHostTx up to here has left the TX ring
+extern unsigned int gHostRxOverrun;     // bytes the DMA wrote over before they were parsed
+extern uint32_t     gHostBaudRate;
+extern char         gHostTextLine[64];  // last "SMS:" line handed to the messenger
+
+// called after each EEPROM write, the time it takes passes in here
+extern void (*gHostOnEepromWrite)(uint16_t Address, uint16_t Size);
+
+// the DMA side of the RX ring, never blocks, overwrites unread bytes like the hardware
+void         HOST_RxWrite(const void *pData, unsigned int Size);
+// bytes that can be written before unread ones get overwritten
+unsigned int HOST_RxFree(void);
+
+// UART_IsCommandAvailable(), the parsed command is in HOST_CommandID()/HOST_CommandData()
+bool           HOST_Poll(void);
+uint16_t       HOST_CommandID(void);
+const uint8_t *HOST_CommandData(void);
+
+// the session and baud rate countdowns of the SysTick handler, every 10ms
+void HOST_SysTick(void);
+// the UART part of one APP_TimeSlice10ms() pass
+void HOST_Tick(void);
+
+// frames a command the way the PC does, returns the frame length
+unsigned int HOST_BuildFrame(uint8_t *pFrame, const void *pCommand, uint16_t Size, bool bObfuscate);
+// pulls the next reply out of gHostTx, returns its payload length or 0
+unsigned int HOST_NextReply(unsigned int *pOffset, uint8_t *pPayload);
+
+// the session id the commands have to carry, set by a 0x0514 hello
+void HOST_StartSession(uint32_t Timestamp);
+
+#endif
@@ -314,5 +314,6 @@ void GUI_DisplaySmallest(const char *pString, uint8_t x, uint8_t y,
 
 void UI_DisplayClear()
 {
+	ST7565_WaitBlit();
 	memset(gFrameBuffer, 0, sizeof(gFrameBuffer));
 }
@@ -29,6 +29,10 @@
 #include "ui/inputbox.h"
 #include "ui/lock.h"
 
+// the lock screen polls the keypad itself, KEYBOARD_Service() isn't running yet
+static KEY_Code_t gKeyReading0     = KEY_INVALID;
+static uint16_t   gDebounceCounter = 0;
+
 static void Render(void)
 {
 	unsigned int i;
@@ -64,6 +68,8 @@ void UI_DisplayLock(void)
 
 		gNextTimeslice = false;
 
+		AUDIO_ServiceBeep();
+
 		Key = KEYBOARD_Poll();
 
 		if (gKeyReading0 == Key)
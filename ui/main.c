@@ -156,7 +156,7 @@ void UI_DisplayAudioBar(void)
 		DrawLevelBar(62, line, bars);
 
 		if (gCurrentFunction == FUNCTION_TRANSMIT)
-			ST7565_BlitFullScreen();
+			ST7565_Flush();
 	}
 }
 #endif
@@ -239,7 +239,7 @@ void DisplayRSSIBar(const bool now)
 		memset(pLine, 0, 23);
 	DrawSmallAntennaAndBars(pLine, Level);
 	if (now)
-		ST7565_BlitFullScreen();
+		ST7565_Flush();
 #endif
 
 }
@@ -310,7 +310,7 @@ void UI_DisplayMain(void)
 
 	if(gLowBattery && !gLowBatteryConfirmed) {
 		UI_DisplayPopup("LOW BATTERY");
-		ST7565_BlitFullScreen();
+		ST7565_Flush();
 		return;
 	}
 
@@ -318,7 +318,7 @@ void UI_DisplayMain(void)
 	{	// tell user how to unlock the keyboard
 		UI_PrintString("Long press #", 0, LCD_WIDTH, 1, 8);
 		UI_PrintString("to unlock",    0, LCD_WIDTH, 3, 8);
-		ST7565_BlitFullScreen();
+		ST7565_Flush();
 		return;
 	}
 
@@ -825,7 +825,7 @@ void UI_DisplayMain(void)
 		}
 	}
 
-	ST7565_BlitFullScreen();
+	ST7565_Flush();
 }
 
 // ***************************************************************************
@@ -979,5 +979,5 @@ void UI_DisplayMenu(void)
 		UI_PrintString(pPrintStr, menu_item_x1, menu_item_x2, 5, 8);
 	}
 
-	ST7565_BlitFullScreen();
+	ST7565_Flush();
 }